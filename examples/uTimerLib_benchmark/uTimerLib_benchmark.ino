@@ -0,0 +1,170 @@
+/**
+ * uTimerLib benchmark example
+ *
+ * Measures on real board, so results can be compared between versions and build flags:
+ *  - Cost of scheduling (setInterval_us + clearTimer), in us and CPU cycles
+ *  - CPU time used by each timer interrupt, comparing a busy loop with and without a running timer
+ *  - Achieved vs requested period over a sweep of values, as mean, min and max of measured periods
+ *
+ * RAM used by TimerLib object is printed too; flash and total RAM footprint are the ones reported by the IDE when compiling this sketch.
+ * Times are measured with micros(), so resolution is that of the board (4us on 16MHz AVR, 1ms on ESP).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+
+#define TICKS 20
+
+volatile unsigned long int ticks = 0;
+volatile unsigned long int firstMicros = 0;
+volatile unsigned long int lastMicros = 0;
+volatile unsigned long int minPeriod = 0;
+volatile unsigned long int maxPeriod = 0;
+
+void timed_function() {
+	unsigned long int now = micros();
+	if (ticks > 0) {
+		unsigned long int period = now - lastMicros;
+		if (ticks == 1 || period < minPeriod) {
+			minPeriod = period;
+		}
+		if (period > maxPeriod) {
+			maxPeriod = period;
+		}
+	} else {
+		firstMicros = now;
+		maxPeriod = 0;
+	}
+	lastMicros = now;
+	ticks++;
+}
+
+void dispatch() {
+	#ifdef UTIMERLIB_DEFERRED
+		TimerLib.dispatch();
+	#endif
+}
+
+// Busy loop iterations during us microseconds
+unsigned long int spin(unsigned long int us) {
+	unsigned long int loops = 0;
+	unsigned long int start = micros();
+	while (micros() - start < us) {
+		loops++;
+		dispatch();
+	}
+	return loops;
+}
+
+void print_cycles(unsigned long int ns) {
+	#ifdef F_CPU
+		Serial.print(" (");
+		Serial.print((unsigned long int) ((unsigned long long) ns * (F_CPU / 1000000) / 1000));
+		Serial.print(" cycles)");
+	#endif
+}
+
+void bench_schedule() {
+	const unsigned int calls = 200;
+	unsigned long int start = micros();
+	for (unsigned int i = 0; i < calls; i++) {
+		TimerLib.setInterval_us(timed_function, 1000000);
+		TimerLib.clearTimer();
+	}
+	unsigned long int ns = (micros() - start) * 1000UL / calls;
+	Serial.print("setInterval_us + clearTimer: ");
+	Serial.print(ns);
+	Serial.print("ns");
+	print_cycles(ns);
+	Serial.println();
+}
+
+void bench_isr() {
+	const unsigned long int window = 1000000;
+	unsigned long int idle = spin(window);
+	ticks = 0;
+	TimerLib.setInterval_us(timed_function, 1000);
+	unsigned long int busy = spin(window);
+	unsigned long int n = ticks;
+	TimerLib.clearTimer();
+	if (n == 0 || busy >= idle) {
+		Serial.println("ISR: not measurable");
+		return;
+	}
+	// Time stolen from busy loop, split between interrupts
+	unsigned long int ns = (unsigned long int) ((unsigned long long) (idle - busy) * window * 1000 / idle / n);
+	Serial.print("ISR + callback: ");
+	Serial.print(ns);
+	Serial.print("ns");
+	print_cycles(ns);
+	Serial.print(", ");
+	Serial.print(n);
+	Serial.println(" interrupts");
+}
+
+void bench_period(unsigned long int us) {
+	ticks = 0;
+	TimerLib.setInterval_us(timed_function, us);
+	unsigned long int start = millis();
+	while (ticks <= TICKS && millis() - start < (us / 1000 + 1) * (TICKS + 2)) {
+		dispatch();
+	}
+	TimerLib.clearTimer();
+	unsigned long int n = ticks;
+
+	Serial.print(us);
+	Serial.print("us: ");
+	if (n < 2) {
+		Serial.println("no ticks");
+		return;
+	}
+	Serial.print("mean ");
+	Serial.print((lastMicros - firstMicros) / (n - 1));
+	Serial.print("us, min ");
+	Serial.print(minPeriod);
+	Serial.print("us, max ");
+	Serial.print(maxPeriod);
+	Serial.print("us, error ");
+	long int error = (long int) (lastMicros - firstMicros) - (long int) (us * (n - 1));
+	Serial.print(error / (long int) (n - 1));
+	Serial.println("us");
+}
+
+void setup() {
+	Serial.begin(57600);
+	delay(2000);
+
+	Serial.println("uTimerLib benchmark");
+	Serial.print("TimerLib RAM: ");
+	Serial.print((unsigned int) sizeof(TimerLib));
+	Serial.println(" bytes");
+	bench_schedule();
+	bench_isr();
+
+	static const unsigned long int periods[] = {100, 250, 1000, 2500, 10000, 16384, 20000, 100000, 1000000};
+	for (unsigned char i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+		bench_period(periods[i]);
+	}
+
+	#ifdef UTIMERLIB_STATS
+		uTimerLibStats stats = TimerLib.getStats();
+		Serial.print("Stats (cycles): latency ");
+		Serial.print(stats.latencyMin);
+		Serial.print(" - ");
+		Serial.print(stats.latencyMax);
+		Serial.print(", callback ");
+		Serial.print(stats.callbackMin);
+		Serial.print(" - ");
+		Serial.print(stats.callbackMax);
+		Serial.print(", overruns ");
+		Serial.println(stats.overruns);
+	#endif
+	Serial.println("Done");
+}
+
+void loop() {
+}
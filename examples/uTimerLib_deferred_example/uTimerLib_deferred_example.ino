@@ -0,0 +1,31 @@
+/**
+ * uTimerLib UTIMERLIB_DEFERRED example
+ *
+ * Timed function prints to Serial, which is safe as it runs from dispatch() on loop(), not from timer interrupt.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_DEFERRED
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+void timed_function() {
+	Serial.println(millis());
+}
+
+void setup() {
+	Serial.begin(57600);
+	TimerLib.setInterval_ms(timed_function, 500);
+}
+
+void loop() {
+	TimerLib.dispatch();
+}
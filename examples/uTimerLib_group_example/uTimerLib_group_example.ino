@@ -0,0 +1,52 @@
+/**
+ * uTimerLib UTIMERLIB_GROUP example
+ *
+ * Four jobs at 1Hz, each 250ms after previous one, run from one timer.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_GROUP
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+volatile unsigned char last = 0;
+
+void job0() {
+	last = 0;
+}
+
+void job1() {
+	last = 1;
+}
+
+void job2() {
+	last = 2;
+}
+
+void job3() {
+	last = 3;
+}
+
+uTimerLibDelegate jobs[] = {job0, job1, job2, job3};
+const unsigned long int phases[] = {0, 250000, 500000, 750000};
+
+void setup() {
+	Serial.begin(57600);
+	TimerLib.setGroup_us(jobs, phases, 4, 1000000);
+}
+
+void loop() {
+	static unsigned char printed = 255;
+	if (last != printed) {
+		printed = last;
+		Serial.println(printed);
+	}
+}
@@ -0,0 +1,40 @@
+/**
+ * uTimerLib UTIMERLIB_LOW_POWER example
+ *
+ * Blinks LED each 2s, sleeping in between. On AVR and SAMD seconds use the 32768Hz clock, so device sleeps in deepest mode;
+ * see README for the needed crystal. millis() and Serial stop while sleeping.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_LOW_POWER
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+volatile bool status = 0;
+
+void timed_function() {
+	status = !status;
+}
+
+void setup() {
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setInterval_s(timed_function, 2);
+}
+
+void loop() {
+	digitalWrite(LED_BUILTIN, status);
+	TimerLib.sleepUntilNext();
+}
@@ -0,0 +1,40 @@
+/**
+ * uTimerLib UTIMERLIB_OVERRUN example
+ *
+ * Timed function lasts longer than its 10ms period each 10 calls; missed ticks are skipped and printed each second.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_OVERRUN
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+volatile unsigned long int calls = 0;
+
+void timed_function() {
+	if (++calls % 10 == 0) {
+		delayMicroseconds(15000);
+	}
+}
+
+void setup() {
+	Serial.begin(57600);
+	TimerLib.setOverrunPolicy(UTIMERLIB_OVERRUN_SKIP);
+	TimerLib.setInterval_ms(timed_function, 10);
+}
+
+void loop() {
+	delay(1000);
+	Serial.print("Calls ");
+	Serial.print(calls);
+	Serial.print(", missed ");
+	Serial.println(TimerLib.getMissed());
+}
@@ -0,0 +1,40 @@
+/**
+ * uTimerLib UTIMERLIB_PULSE_TRAIN example
+ *
+ * Toggles a pin following an accelerating table of periods, as a stepper ramp, and stops.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_PULSE_TRAIN
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+const unsigned long int periods[] = {20000, 15000, 11000, 8000, 6000, 5000, 5000, 5000};
+
+volatile bool status = 0;
+
+void step() {
+	status = !status;
+	digitalWrite(LED_BUILTIN, status);
+}
+
+void setup() {
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setPulseTrain_us(step, periods, sizeof(periods) / sizeof(periods[0]));
+}
+
+void loop() {
+}
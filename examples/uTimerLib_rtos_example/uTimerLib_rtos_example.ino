@@ -0,0 +1,34 @@
+/**
+ * uTimerLib UTIMERLIB_RTOS example
+ *
+ * Timed function is run by a FreeRTOS task, so it can block with delay(). ESP32 only (and ST's STM32 core with STM32FreeRTOS).
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_RTOS
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+void timed_function() {
+	Serial.print("Start ");
+	Serial.println(millis());
+	delay(100);
+	Serial.print("End ");
+	Serial.println(millis());
+}
+
+void setup() {
+	Serial.begin(115200);
+	TimerLib.setInterval_ms(timed_function, 1000);
+}
+
+void loop() {
+}
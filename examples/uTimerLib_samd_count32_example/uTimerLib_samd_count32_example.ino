@@ -0,0 +1,38 @@
+/**
+ * uTimerLib UTIMERLIB_SAMD_COUNT32 example
+ *
+ * Blinks LED each 1.5s on SAMD21 / SAMD51, using a 32 bit TC pair so the whole period is one timer loop.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_SAMD_COUNT32
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+volatile bool status = 0;
+
+void timed_function() {
+	status = !status;
+}
+
+void setup() {
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setInterval_us(timed_function, 1500000);
+}
+
+void loop() {
+	digitalWrite(LED_BUILTIN, status);
+}
@@ -0,0 +1,47 @@
+/**
+ * uTimerLib UTIMERLIB_SAMPLING example
+ *
+ * Samples A0 at 1kHz by DMA on SAMD21 / SAMD51 and prints the mean of each half buffer.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_SAMPLING
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#define SAMPLES 64
+
+uint16_t buffer[SAMPLES];
+volatile unsigned long int mean = 0;
+volatile bool ready = false;
+
+void half_full(uint16_t * samples, unsigned int count) {
+	unsigned long int sum = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		sum += samples[i];
+	}
+	mean = sum / count;
+	ready = true;
+}
+
+void setup() {
+	Serial.begin(57600);
+	if (!TimerLib.setSampling_us(A0, buffer, SAMPLES, half_full, 1000)) {
+		Serial.println("Sampling not started");
+	}
+}
+
+void loop() {
+	if (ready) {
+		ready = false;
+		Serial.println(mean);
+	}
+}
@@ -0,0 +1,50 @@
+/**
+ * uTimerLib UTIMERLIB_SLOTS example
+ *
+ * Blinks LED each 500ms and prints millis() each 2s, from two slots of one timer, stopping prints after 11s.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_SLOTS 4
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+volatile bool status = 0;
+uTimerLibHandle printHandle = UTIMERLIB_INVALID_HANDLE;
+
+void blink() {
+	status = !status;
+}
+
+void print_millis() {
+	Serial.println(millis());
+}
+
+void stop_prints() {
+	TimerLib.clearTimer(printHandle);
+}
+
+void setup() {
+	Serial.begin(57600);
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setInterval_ms(blink, 500);
+	printHandle = TimerLib.setInterval_s(print_millis, 2);
+	TimerLib.setTimeout_s(stop_prints, 11);
+}
+
+void loop() {
+	digitalWrite(LED_BUILTIN, status);
+}
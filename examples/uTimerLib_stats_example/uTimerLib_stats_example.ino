@@ -0,0 +1,45 @@
+/**
+ * uTimerLib UTIMERLIB_STATS example
+ *
+ * Runs a 1ms interval and prints timer statistics each second.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_STATS
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+volatile unsigned long int ticks = 0;
+
+void timed_function() {
+	ticks++;
+}
+
+void setup() {
+	Serial.begin(57600);
+	TimerLib.setInterval_us(timed_function, 1000);
+}
+
+void loop() {
+	delay(1000);
+	uTimerLibStats stats = TimerLib.getStats();
+	TimerLib.resetStats();
+	Serial.print("ISRs ");
+	Serial.print(stats.isrCount);
+	Serial.print(", latency (cycles) ");
+	Serial.print(stats.latencyMin);
+	Serial.print(" - ");
+	Serial.print(stats.latencyMax);
+	Serial.print(", callback mean ");
+	Serial.print(stats.callbackMean);
+	Serial.print(", overruns ");
+	Serial.println(stats.overruns);
+}
@@ -0,0 +1,46 @@
+/**
+ * uTimerLib UTIMERLIB_TICKLESS example
+ *
+ * Two blinks of different periods, grouped by slack so timer only wakes up device when one of them is due.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_SLOTS 4
+#define UTIMERLIB_TICKLESS
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+volatile bool status = 0;
+
+void blink_fast() {
+	status = !status;
+}
+
+void blink_slow() {
+	status = !status;
+}
+
+void setup() {
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setInterval_ms(blink_fast, 300);
+	uTimerLibHandle slow = TimerLib.setInterval_ms(blink_slow, 1000);
+	TimerLib.setSlack_us(slow, 50000);
+}
+
+void loop() {
+	digitalWrite(LED_BUILTIN, status);
+	TimerLib.sleepUntilNext();
+}
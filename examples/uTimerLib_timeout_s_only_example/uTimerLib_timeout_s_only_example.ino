@@ -0,0 +1,39 @@
+/**
+ * uTimerLib UTIMERLIB_TIMEOUT_ONLY + UTIMERLIB_S_ONLY example
+ *
+ * Smallest profile for timeouts, as for ATtiny85: only setTimeout_s exists. Turns LED on 3s after start.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_TIMEOUT_ONLY
+#define UTIMERLIB_S_ONLY
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+#ifndef LED_BUILTIN
+	// change to fit your needs
+	#define LED_BUILTIN 13
+#endif
+
+volatile bool status = 0;
+
+void timed_function() {
+	status = 1;
+}
+
+void setup() {
+	pinMode(LED_BUILTIN, OUTPUT);
+	TimerLib.setTimeout_s(timed_function, 3);
+}
+
+void loop() {
+	digitalWrite(LED_BUILTIN, status);
+}
@@ -0,0 +1,34 @@
+/**
+ * uTimerLib UTIMERLIB_TRACE example
+ *
+ * Runs a 1.5s interval and prints last timer events each 5s.
+ *
+ * UTIMERLIB_xxx values must be the same for the whole library build, so this sketch defines them and includes uTimerLib.cpp
+ * to build library with them (library is linked as an archive, so its own default build is not used).
+ *
+ * @author Naguissa
+ * @url https://www.github.com/Naguissa/uTimerLib
+ * @url https://www.foroelectro.net
+ */
+
+#define UTIMERLIB_TRACE
+
+#include "Arduino.h"
+#include "uTimerLib.h"
+#include "uTimerLib.cpp"
+
+volatile unsigned long int calls = 0;
+
+void timed_function() {
+	calls++;
+}
+
+void setup() {
+	Serial.begin(57600);
+	TimerLib.setInterval_us(timed_function, 1500000);
+}
+
+void loop() {
+	delay(5000);
+	TimerLib.dumpTrace(Serial);
+}
@@ -1,279 +1,511 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.ATTINY.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-
-#if (defined(ARDUINO_ARCH_AVR) && (defined(ARDUINO_attiny) || defined(ARDUINO_AVR_ATTINYX4) || defined(ARDUINO_AVR_ATTINYX5) || defined(ARDUINO_AVR_ATTINYX7) || defined(ARDUINO_AVR_ATTINYX8) || defined(ARDUINO_AVR_ATTINYX61) || defined(ARDUINO_AVR_ATTINY43) || defined(ARDUINO_AVR_ATTINY828) || defined(ARDUINO_AVR_ATTINY1634) || defined(ARDUINO_AVR_ATTINYX313))) && defined(UTIMERLIB_HW_COMPILE)
-#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-
-	#ifndef TCCR1A
-		#define TCCR1A GTCCR
-	#endif
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-
-		unsigned char CSMask = 0;
-		// For this notes, we asume 16MHz CPU. We recalculate 'us' if not:
-		if (F_CPU != 16000000) {
-			us = F_CPU / 16000000 * us;
-		}
-		TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-		cli();
-		// ATTiny, using Timer1. Counts at 16MHz (it other speed is used we recalculate us before)
-		/*
-		Prescaler: TCCR1; 4 last bits, CS10, CS11, CS12 and CS13
-
-		CS13	CS12	CS11	CS10	Freq		Divisor		Base Delay		Overflow delay
-		  0		  0		  0		 0		stopped		    -		    -			        -
-		  0		  0		  0		 1		16MHz		    1		   0.0625us			    16us
-		  0		  0		  1		 0		16MHz		    2		   0.125us			    32us
-		  0		  0		  1		 1		16MHz		    4		   0.25us			    64us
-		  0		  1		  0		 0		16MHz		    8		   0.5us			   128us
-		  0		  1		  0		 1		16MHz		   16		   1us				   256us
-		  0		  1		  1		 0		16MHz		   32		   2us				   512us
-		  0		  1		  1		 1		16MHz		   64		   4us				  1024us
-		  1		  0		  0		 0		16MHz		  128		   8us				  2048us
-		  1		  0		  0		 1		16MHz		  256		  16us				  4096us
-		  1		  0		  1		 0		16MHz		  512		  32us				  8192us
-		  1		  0		  1		 1		16MHz		 1024		  64us				 16384us
-		  1		  1		  0		 0		16MHz		 2048		 128us				 32768us
-		  1		  1		  0		 1		16MHz		 4096		 256us				 65536us
-		  1		  1		  1		 0		16MHz		 8192		 512us				131072us
-		  1		  1		  1		 1		16MHz		16384		1024us				262144us
-		*/
-		if (us >= 262144) {
-			CSMask = (1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10);
-			_overflows = us / 262144;
-			_remaining = 256 - ((us % 262144) / 1024 + 0.5); // + 0.5 is round for positive numbers
-		} else {
-			if (us >= 131072) {
-				CSMask = (1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10);
-				_remaining = 256 - (us / 1024 + 0.5); // + 0.5 is round for positive numbers
-			} else if (us >= 65536) {
-				CSMask = (1<<CS13) | (1<<CS12) | (1<<CS11);
-				_remaining = 256 - (us / 512 + 0.5); // + 0.5 is round for positive numbers
-			} else if (us >= 32768) {
-				CSMask = (1<<CS13) | (1<<CS12) | (1<<CS10);
-				_remaining = 256 - (us / 256 + 0.5); // + 0.5 is round for positive numbers
-			} else if (us >= 16384) {
-				CSMask = (1<<CS13) | (1<<CS12);
-				_remaining = 256 - (us / 128 + 0.5); // + 0.5 is round for positive numbers
-			} else if (us >= 8192) {
-				CSMask = (1<<CS13) | (1<<CS11) | (1<<CS10);
-				_remaining = 256 - (us / 64 + 0.5); // + 0.5 is round for positive numbers
-			} else if (us >= 4096) {
-				CSMask = (1<<CS13) | (1<<CS11);
-				_remaining = 256 - (us / 32 + 0.5);
-			} else if (us >= 2048) {
-				CSMask = (1<<CS13) | (1<<CS10);
-				_remaining = 256 - (us / 16 + 0.5);
-			} else if (us >= 1024) {
-				CSMask = (1<<CS13);
-				_remaining = 256 - (us / 8 + 0.5);
-			} else if (us >= 512) {
-				CSMask = (1<<CS12) | (1<<CS11) | (1<<CS10);
-				_remaining = 256 - (us / 4 + 0.5);
-			} else if (us >= 256) {
-				CSMask = (1<<CS12) | (1<<CS11);
-				_remaining = 256 - (us / 2 + 0.5);
-			} else if (us >= 128) {
-				CSMask = (1<<CS12) | (1<<CS10);
-				_remaining = 256 - us;
-			} else if (us >= 64) {
-				CSMask = (1<<CS12);
-				_remaining = 256 - (us * 2);
-			} else if (us >= 32) {
-				CSMask = (1<<CS11) | (1<<CS10);
-				_remaining = 256 - (us * 4);
-			} else if (us >= 16) {
-				CSMask = (1<<CS11);
-				_remaining = 256 - (us * 8);
-			} else {
-				CSMask = (1<<CS10);
-				_remaining = 256 - (us * 16);
-			}
-			_overflows = 0;
-		}
-
-		__overflows = _overflows;
-		__remaining = _remaining;
-		_overflows += 1; // Fix interrupt incorrectly firing just after sei()
-
-		PLLCSR &= ~(1<<PCKE); 		// Internal clock
-		// TCCR1A = (1<<COM1A1);	// Normal operation
-
-		TCCR1 |= (1 << CTC1);  // clear timer on compare match
-		TCCR1 = TCCR1 & ~((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10)) | CSMask;	// Sets divisor
-
-		TCNT1 = 0;				// Clean timer count
-		TIMSK |= (1 << TOIE1);		// Enable overflow interruption when 0
-		sei();
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-		unsigned char CSMask = 0;
-		// For this notes, we asume 16MHz CPU. We recalculate 'us' if not:
-		if (F_CPU != 16000000) {
-			s = F_CPU / 16000000 * s;
-		}
-		TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-		cli();
-		// ATTiny, using Timer1. Counts at 16MHz (it other speed is used we recalculate us before)
-		/*
-		Prescaler: TCCR1; 4 last bits, CS10, CS11, CS12 and CS13
-
-		CS13	CS12	CS11	CS10	Freq		Divisor		Base Delay		Overflow delay
-		  1		  1		  1		 1		16MHz		16384		1024us				262144us
-		*/
-
-		CSMask = (1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10);
-		_overflows = s * 1000000 / 262144;
-		_remaining = 256 - (((s * 1000000) % 262144) / 1024 + 0.5); // + 0.5 is round for positive numbers
-
-		__overflows = _overflows;
-		__remaining = _remaining;
-		_overflows += 1; // Fix interrupt incorrectly firing just after sei()
-
-		PLLCSR &= ~(1<<PCKE); 		// Internal clock
-		// TCCR1A = (1<<COM1A1);	// Normal operation
-		TCCR1 = TCCR1 | CSMask;	// Sets divisor
-
-		// Clean counter in normal operation, load remaining when overflows == 0
-		TCNT1 = 0;				// Clean timer count
-		TIMSK |= (1 << TOIE1);		// Enable overflow interruption when 0
-		sei();
-	}
-
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() {
-		TCNT1 = _remaining;
-	}
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-		TIMSK &= ~(1 << TOIE1);		// Disable overflow interruption when 0
-//		SREG = (SREG & 0b01111111); // Disable interrupts without modifiying other interrupts
-
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-		if (_overflows > 0) {
-			_overflows--;
-		}
-		if (_overflows == 0 && _remaining > 0) {
-				// Load remaining count to counter
-				_loadRemaining();
-				// And clear remaining count
-				_remaining = 0;
-		} else if (_overflows == 0 && _remaining == 0) {
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
-				if (__overflows == 0) {
-					_remaining = __remaining;
-					_loadRemaining();
-					_remaining = 0;
-				} else {
-					_overflows = __overflows;
-					_remaining = __remaining;
-				}
-			}
-			_cb();
-		}
-	}
-
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	ISR(TIMER1_OVF_vect) {
-		TimerLib._interrupt();
-	}
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.ATTINY.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+
+#if (defined(ARDUINO_ARCH_AVR) && (defined(ARDUINO_attiny) || defined(ARDUINO_AVR_ATTINYX4) || defined(ARDUINO_AVR_ATTINYX5) || defined(ARDUINO_AVR_ATTINYX7) || defined(ARDUINO_AVR_ATTINYX8) || defined(ARDUINO_AVR_ATTINYX61) || defined(ARDUINO_AVR_ATTINY43) || defined(ARDUINO_AVR_ATTINY828) || defined(ARDUINO_AVR_ATTINY1634) || defined(ARDUINO_AVR_ATTINYX313))) && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+	#include <avr/sleep.h>
+
+
+	#ifndef TCCR1A
+		#define TCCR1A GTCCR
+	#endif
+
+
+	// Prescalers, as powers of 2, of CS13:CS10 values 1 and up
+	static const unsigned char _shifts[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		// Times on this notes are for 16MHz CPU; counts are calculated from real F_CPU
+		unsigned long int counts;
+		unsigned char k = _fitPrescaler(us, F_CPU, _shifts, sizeof(_shifts), 255, counts);
+		unsigned char CSMask = (k + 1) << CS10;	// CS13:CS10 value is prescaler power of 2 plus 1
+		// ATTiny, using Timer1
+		/*
+		Prescaler: TCCR1; 4 last bits, CS10, CS11, CS12 and CS13
+
+		CS13	CS12	CS11	CS10	Freq		Divisor		Base Delay		Overflow delay
+		  0		  0		  0		 0		stopped		    -		    -			        -
+		  0		  0		  0		 1		16MHz		    1		   0.0625us			    16us
+		  0		  0		  1		 0		16MHz		    2		   0.125us			    32us
+		  0		  0		  1		 1		16MHz		    4		   0.25us			    64us
+		  0		  1		  0		 0		16MHz		    8		   0.5us			   128us
+		  0		  1		  0		 1		16MHz		   16		   1us				   256us
+		  0		  1		  1		 0		16MHz		   32		   2us				   512us
+		  0		  1		  1		 1		16MHz		   64		   4us				  1024us
+		  1		  0		  0		 0		16MHz		  128		   8us				  2048us
+		  1		  0		  0		 1		16MHz		  256		  16us				  4096us
+		  1		  0		  1		 0		16MHz		  512		  32us				  8192us
+		  1		  0		  1		 1		16MHz		 1024		  64us				 16384us
+		  1		  1		  0		 0		16MHz		 2048		 128us				 32768us
+		  1		  1		  0		 1		16MHz		 4096		 256us				 65536us
+		  1		  1		  1		 0		16MHz		 8192		 512us				131072us
+		  1		  1		  1		 1		16MHz		16384		1024us				262144us
+		*/
+		_attachInterrupt_raw(CSMask, counts);
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to F_CPU / hz and its fraction kept
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			unsigned long int counts;
+			unsigned char k = _fitPrescalerHz(hz, F_CPU, _shifts, sizeof(_shifts), 255, counts);
+			_attachInterrupt_raw((k + 1) << CS10, counts);
+			return _milliHz(F_CPU, _shifts[k], counts, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer and interrupts for already calculated prescaler and counts of each period
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	CSMask		Clock select bits (prescaler)
+	 * @param	counts		Timer counts of each period
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned char CSMask, unsigned long int counts) {
+		TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
+		unsigned char sreg = SREG; // Also run from timer interrupt (tickless scheduler, callbacks), so interrupts are restored, never enabled
+		cli();
+		_overflows = counts >> 8;
+		_remaining = (256 - (counts & 0xFF)) & 0xFF;
+
+		__overflows = _overflows;
+		__remaining = _remaining;
+		_overflows += 1; // Fix interrupt incorrectly firing just after sei()
+
+		PLLCSR &= ~(1<<PCKE); 		// Internal clock
+		// TCCR1A = (1<<COM1A1);	// Normal operation
+
+		TCCR1 |= (1 << CTC1);  // clear timer on compare match
+		TCCR1 = (TCCR1 & ~((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10))) | CSMask;	// Sets divisor
+
+		TCNT1 = 0;				// Clean timer count
+		TIMSK |= (1 << TOIE1);		// Enable overflow interruption when 0
+		SREG = sreg;
+	}
+
+
+	#ifndef UTIMERLIB_US_ONLY
+		/**
+		 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		Desired timing in microseconds
+		 */
+		void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+			if (us == 0) { // Not valid
+				return;
+			}
+			unsigned char CSMask = 0;
+			// Biggest prescaler, 16384; counts are calculated from real F_CPU
+			unsigned long long counts = _longToCounts(us, F_CPU, 14);
+			TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
+			unsigned char sreg = SREG;
+			cli();
+			// ATTiny, using Timer1
+			/*
+			Prescaler: TCCR1; 4 last bits, CS10, CS11, CS12 and CS13
+
+			CS13	CS12	CS11	CS10	Freq		Divisor		Base Delay		Overflow delay
+			  1		  1		  1		 1		16MHz		16384		1024us				262144us
+			*/
+
+			CSMask = (1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10);
+			_overflows = counts >> 8;
+			_remaining = (256 - (counts & 0xFF)) & 0xFF;
+
+			__overflows = _overflows;
+			__remaining = _remaining;
+			_overflows += 1; // Fix interrupt incorrectly firing just after sei()
+
+			PLLCSR &= ~(1<<PCKE); 		// Internal clock
+			// TCCR1A = (1<<COM1A1);	// Normal operation
+			TCCR1 = TCCR1 | CSMask;	// Sets divisor
+
+			// Clean counter in normal operation, load remaining when overflows == 0
+			TCNT1 = 0;				// Clean timer count
+			TIMSK |= (1 << TOIE1);		// Enable overflow interruption when 0
+			SREG = sreg;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_HW_WAVE
+		/**
+		 * \brief Starts a square wave of us microseconds period on pin, toggled by timer on each compare match, without interrupt
+		 *
+		 * Pin must be OC1A (PB1) and half period must fit in one loop of 256 counts: 262144us at 16MHz. Timer1 is cleared on
+		 * OCR1C compare match (CTC1), so OCR1C is TOP while it runs.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	pin		Arduino pin number
+		 * @param	us		Square wave period in microseconds
+		 * @return	false if pin is not OC1A or half period does not fit
+		 */
+		bool uTimerLib::_attachSquareWave(unsigned char pin, unsigned long int us) {
+			if (digitalPinToPort(pin) != PB || digitalPinToBitMask(pin) != (1 << PB1)) {
+				return false;
+			}
+			// Half period counts, at half clock
+			unsigned long int counts;
+			unsigned char k = _fitPrescaler(us, F_CPU / 2, _shifts, sizeof(_shifts), 256, counts);
+			if (counts > 256) {
+				return false;
+			}
+			TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A));	// No interrupt
+			unsigned char sreg = SREG;
+			cli();
+			__overflows = _overflows = 0;
+			__remaining = _remaining = 0;
+			PLLCSR &= ~(1<<PCKE); 		// Internal clock
+			OCR1C = counts - 1;
+			OCR1A = 0;
+			TCNT1 = 0;
+			TCCR1 = (1 << CTC1) | (1 << COM1A0) | ((k + 1) << CS10);	// Toggle OC1A on compare match, sets divisor
+			SREG = sreg;
+			return true;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	true
+		 */
+		bool uTimerLib::_changePeriod_us(unsigned long int us) {
+			unsigned long int counts, num, den;
+			unsigned char k = _fitPrescaler(us, F_CPU, _shifts, sizeof(_shifts), 255, counts, num, den);
+			_setNext(counts >> 8, (256 - (counts & 0xFF)) & 0xFF, 0, num, den, (k + 1) << CS10);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us, with its prescaler
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+			TCCR1 = (TCCR1 & ~((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10))) | _nextPrescaler;
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() {
+		TCNT1 = _remaining;
+	}
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		if (_type == UTIMERLIB_TYPE_WAVE) {
+			TCCR1 &= ~((1 << COM1A1) | (1 << COM1A0));	// Disconnect OC1A, giving pin back to digitalWrite
+			OCR1C = 255;	// Whole 8 bit loops again
+		}
+		_type = UTIMERLIB_TYPE_OFF;
+
+		TIMSK &= ~(1 << TOIE1);		// Disable overflow interruption when 0
+//		SREG = (SREG & 0b01111111); // Disable interrupts without modifiying other interrupts
+
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * Timer1 runs from system clock or PLL, so only CPU is stopped (idle mode). Any other interrupt wakes up CPU, and it sleeps again.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		set_sleep_mode(SLEEP_MODE_IDLE);
+		for (;;) {
+			cli();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF || _type == UTIMERLIB_TYPE_WAVE) { // Square wave has no calls
+				sei();
+				return;
+			}
+			sleep_enable();
+			sei();
+			sleep_cpu(); // Instruction after sei() always runs, so no interrupt is lost between check and sleep
+			sleep_disable();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Period is __overflows loops of 256 counts and a partial loop, loaded with __remaining, when there is one.
+	 * Overflow flag tells when a loop has ended while its interrupt is still pending.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		unsigned char sreg = SREG;
+		cli();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			SREG = sreg;
+			return false;
+		}
+		unsigned long int count = TCNT1;
+		bool pending = TIFR & (1 << TOV1);
+		if (pending) { // Read again, as loop may end just after first read
+			count = TCNT1;
+		}
+		if (_type == UTIMERLIB_TYPE_WAVE) { // Loops of OCR1C + 1 counts, each one a half period
+			elapsed = count;
+			total = OCR1C + 1;
+			hz = F_CPU >> ((TCCR1 & ((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10))) - 1);
+			SREG = sreg;
+			return true;
+		}
+		unsigned long int loops = __overflows;
+		unsigned long int partial = __remaining > 0 ? 256 - __remaining : 0;
+		total = ((unsigned long long) loops << 8) + partial;
+		if (_overflows > 0) { // On whole loops; first one after start is counted as done
+			unsigned long int done = loops > _overflows ? loops - _overflows : 0;
+			elapsed = ((unsigned long long) (done + (pending ? 1 : 0)) << 8) + count;
+		} else if (pending) { // Period has ended
+			elapsed = count;
+		} else { // On partial loop, started on __remaining
+			elapsed = ((unsigned long long) loops << 8) + (count > __remaining ? count - __remaining : 0);
+		}
+		if (elapsed > total) {
+			elapsed = total;
+		}
+		unsigned char cs = TCCR1 & ((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10));
+		hz = F_CPU >> (cs > 0 ? cs - 1 : 0);
+		SREG = sreg;
+		return true;
+	}
+
+	#ifdef UTIMERLIB_OVERRUN
+		/**
+		 * \brief Timer interrupt already pending, called from it when timed function returns, is end of current period
+		 *
+		 * Interrupts are disabled, so overflow flag is set for at most one ended loop; it ends period when no loop nor
+		 * remaining count is left after it.
+		 *
+		 * Note: This is device-dependant
+		 */
+		bool uTimerLib::_overrunPending() {
+			return _overflows <= 1 && _remaining == 0 && (TIFR & (1 << TOV1));
+		}
+	#endif
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function implements oferflow control to offer user desired timings.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		if (_overflows > 0) {
+			_overflows--;
+		}
+		if (_overflows == 0 && _remaining > 0) {
+				UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_REMAINING);
+				// Load remaining count to counter
+				_loadRemaining();
+				// And clear remaining count
+				_remaining = 0;
+		} else if (_overflows == 0 && _remaining == 0) {
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			}
+			#ifndef UTIMERLIB_TIMEOUT_ONLY
+				else if (_type == UTIMERLIB_TYPE_INTERVAL) {
+					#ifdef UTIMERLIB_RELOAD
+						if (_nextReady) {
+							_loadNext();
+						}
+					#endif
+					// Fraction count is added to partial loop, loading one count less; there is none if period is whole loops
+					unsigned char fraction = _fracStep();
+					_remaining = __remaining > 1 ? __remaining - fraction : __remaining;
+					if (__overflows == 0) {
+						_loadRemaining();
+						_remaining = 0;
+					} else {
+						_overflows = __overflows;
+					}
+				}
+			#endif
+			_callback();
+		}
+		#ifdef UTIMERLIB_TRACE
+			else {
+				_traceEvent(UTIMERLIB_TRACE_OVERFLOW);
+			}
+		#endif
+	}
+
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer prescaler, as power of 2, to convert timer counts to CPU cycles
+		 */
+		static inline unsigned char _statsShift() {
+			unsigned char cs = TCCR1 & ((1<<CS13) | (1<<CS12) | (1<<CS11) | (1<<CS10));
+			return cs > 0 ? cs - 1 : 0;
+		}
+
+		/**
+		 * \brief Timer count, in CPU cycles. It restarts on overflow, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			return (unsigned long int) TCNT1 << _statsShift();
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * ATtiny has no cycle counter, so timer count register is used.
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsCycles() {
+			return _statsLatency();
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp, up to two timer loops
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+			unsigned long int now = TCNT1;
+			if (TIFR & (1 << TOV1)) { // Loop ended while measuring; read again, as it may end just after first read
+				now = TCNT1 + 256UL;
+			}
+			now <<= _statsShift();
+			return now > start ? now - start : 0;
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+
+
+
+
+	/**
+	 * \brief Attach Interrupts using internal functionality
+	 *
+	 * Note: This is device-dependant
+	 */
+	ISR(TIMER1_OVF_vect) {
+		TimerLib._interrupt();
+	}
+
+#endif
+#endif
@@ -1,361 +1,719 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.AVR.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-
-#if (defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_AVR)) && !defined(ARDUINO_attiny) && defined(UTIMERLIB_HW_COMPILE)
-#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-
-		unsigned char CSMask = 0;
-		// For this notes, we asume 16MHz CPU. We recalculate 'us' if not:
-		if (F_CPU != 16000000) {
-			us = F_CPU / 16000000 * us;
-		}
-
-		// Leonardo and other 32U4 boards
-		#ifdef __AVR_ATmega32U4__
-			TIMSK3 &= ~((1 << TOIE3) | (1 << OCIE3A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-			cli();
-			// 32U4, using Timer3. Counts at 16MHz
-			/*
-			Prescaler: TCCR3B; 3 last bits, CS30, CS31 and CS32
-
-			CS32	CS31	CS30	Freq		Divisor		Base Delay	Overflow delay
-			  0		  0		  0		stopped		   -		    -			    -
-			  0		  0		  1		16MHz		   1		0.0625us			   16us
-			  0		  1		  0		2MHz		   8		   0.5us			  128us
-			  0		  1		  1		250KHz		  64		     4us			 1024us
-			  1		  0		  0		62.5KHz		 256		    16us			 4096us
-			  1		  0		  1		15.625KHz	1024		    64us			16384us
-			*/
-			if (us >= 16384) {
-				CSMask = (1<<CS32) | (1<<CS31) | (1<<CS30);
-				_overflows = us / 16384;
-				_remaining = 256 - ((us % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			} else {
-				if (us >= 4096) {
-					CSMask = (1<<CS32) | (1<<CS30);
-					_remaining = 256 - (us / 64 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 2048) {
-					CSMask = (1<<CS32);
-					_remaining = 256 - (us / 16 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 512) {
-					CSMask = (1<<CS31) | (1<<CS30);
-					_remaining = 256 - (us / 4 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 16) {
-					CSMask = (1<<CS31);
-					_remaining = 256 - us * 2;
-				} else {
-					CSMask = (1<<CS30);
-					_remaining = 256 - (us * 16);
-				}
-				_overflows = 0;
-			}
-
-			__overflows = _overflows;
-			__remaining = _remaining;
-			_overflows += 1; // Fix interrupt incorrectly firing just after sei()
-			//ASSR &= ~(1<<AS3); 		// Internal clock - Unique mode for Timer3
-			TCCR3A = (1<<COM3A1);	// Normal operation
-			TCCR3B = TCCR3B & ~((1<<CS32) | (1<<CS31) | (1<<CS30)) | CSMask;	// Sets divisor
-
-			TCNT3 = 0;				// Clean timer count
-			TIMSK3 |= (1 << TOIE3);		// Enable overflow interruption when 0
-			sei();
-		#else
-			TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-			cli();
-			// AVR, using Timer2. Counts at 16MHz
-			/*
-			Prescaler: TCCR2B; 3 last bits, CS20, CS21 and CS22
-
-			CS22	CS21	CS20	Freq		Divisor		Base Delay	Overflow delay
-			  0		  0		  0		stopped		   -		    -			    -
-			  0		  0		  1		16MHz		   1		0.0625us			   16us
-			  0		  1		  0		2MHz		   8		   0.5us			  128us
-			  0		  1		  1		500KHz		  32		     2us			  512us
-			  1		  0		  0		250KHz		  64		     4us			 1024us
-			  1		  0		  1		125KHz		 128		     8us			 2048us
-			  1		  1		  0		62.5KHz		 256		    16us			 4096us
-			  1		  1		  1		15.625KHz	1024		    64us			16384us
-			*/
-			if (us >= 16384) {
-				CSMask = (1<<CS22) | (1<<CS21) | (1<<CS20);
-				_overflows = us / 16384;
-				_remaining = 256 - ((us % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			} else {
-				if (us >= 4096) {
-					CSMask = (1<<CS22) | (1<<CS21) | (1<<CS20);
-					_remaining = 256 - (us / 64 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 2048) {
-					CSMask = (1<<CS22) | (1<<CS21);
-					_remaining = 256 - (us / 16 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 1024) {
-					CSMask = (1<<CS22) | (1<<CS20);
-					_remaining = 256 - (us / 8 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 512) {
-					CSMask = (1<<CS22);
-					_remaining = 256 - (us / 4 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 128) {
-					CSMask = (1<<CS21) | (1<<CS20);
-					_remaining = 256 - (us / 2 + 0.5); // + 0.5 is round for positive numbers
-				} else if (us >= 16) {
-					CSMask = (1<<CS21);
-					_remaining = 256 - us * 2;
-				} else {
-					CSMask = (1<<CS20);
-					_remaining = 256 - (us * 16);
-				}
-				_overflows = 0;
-			}
-
-			__overflows = _overflows;
-			__remaining = _remaining;
-			_overflows += 1; // Fix interrupt incorrectly firing just after sei()
-			ASSR &= ~(1<<AS2); 		// Internal clock
-			TCCR2A = (1<<COM2A1);	// Normal operation
-			TCCR2B = TCCR2B & ~((1<<CS22) | (1<<CS21) | (1<<CS20)) | CSMask;	// Sets divisor
-
-			TCNT2 = 0;				// Clean timer count
-			TIMSK2 |= (1 << TOIE2);		// Enable overflow interruption when 0
-			sei();
-		#endif
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		unsigned char CSMask = 0;
-		// For this notes, we asume 16MHz CPU. We recalculate 's' if not:
-		if (F_CPU != 16000000) {
-			s = F_CPU / 16000000 * s;
-		}
-
-		// Leonardo and other 32U4 boards
-		#ifdef __AVR_ATmega32U4__
-			TIMSK3 &= ~((1 << TOIE3) | (1 << OCIE3A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-			cli();
-
-			/*
-			Using longest mode from _ms function
-			CS32	CS31	CS30	Freq		Divisor		Base Delay	Overflow delay
-			  1		  0		  0		15.625KHz	1024		    64us			16384us
-			*/
-			CSMask = (1<<CS32);
-			if (_overflows > 500000) {
-				_overflows = s / 16384 * 1000000;
-			} else {
-				_overflows = s * 1000000 / 16384;
-			}
-			// Original: _remaining = 256 - round(((us * 1000000) % 16384) / 64);
-			// Anti-Overflow trick:
-			if (s > 16384) {
-				unsigned long int temp = floor(s / 16384) * 16384;
-				_remaining = 256 - ((((s - temp) * 1000000) % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			} else {
-				_remaining = 256 - (((s * 1000000) % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			}
-
-			__overflows = _overflows;
-			__remaining = _remaining;
-			_overflows += 1;
-
-			//ASSR &= ~(1<<AS3); 		// Internal clock - Unique mode for Timer3
-			TCCR3A = (1<<COM3A1);	// Normal operation
-			TCCR3B = TCCR3B & ~((1<<CS32) | (1<<CS31) | (1<<CS30)) | CSMask;	// Sets divisor
-
-			// Clean counter in normal operation, load remaining when overflows == 0
-			TCNT3 = 0;				// Clean timer count
-			TIMSK3 |= (1 << TOIE3);		// Enable overflow interruption when 0
-			sei();
-
-		#else
-			// Arduino AVR
-			TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
-			cli();
-
-			/*
-			Using longest mode from _ms function
-			CS22	CS21	CS20	Freq		Divisor		Base Delay	Overflow delay
-			  1		  1		  1		15.625KHz	1024		    64us			16384us
-			*/
-			CSMask = (1<<CS22) | (1<<CS21) | (1<<CS20);
-			if (_overflows > 500000) {
-				_overflows = s / 16384 * 1000000;
-			} else {
-				_overflows = s * 1000000 / 16384;
-			}
-			// Original: _remaining = 256 - round(((us * 1000000) % 16384) / 64);
-			// Anti-Overflow trick:
-			if (s > 16384) {
-				unsigned long int temp = floor(s / 16384) * 16384;
-				_remaining = 256 - ((((s - temp) * 1000000) % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			} else {
-				_remaining = 256 - (((s * 1000000) % 16384) / 64 + 0.5); // + 0.5 is round for positive numbers
-			}
-
-			__overflows = _overflows;
-			__remaining = _remaining;
-			_overflows += 1;
-
-			ASSR &= ~(1<<AS2); 		// Internal clock
-			TCCR2A = (1<<COM2A1);	// Normal operation
-			TCCR2B = TCCR2B & ~((1<<CS22) | (1<<CS21) | (1<<CS20)) | CSMask;	// Sets divisor
-
-			// Clean counter in normal operation, load remaining when overflows == 0
-			TCNT2 = 0;				// Clean timer count
-			TIMSK2 |= (1 << TOIE2);		// Enable overflow interruption when 0
-			sei();
-		#endif
-	}
-
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() {
-		#ifdef __AVR_ATmega32U4__
-			TCNT3 = _remaining;
-		#else
-			TCNT2 = _remaining;
-		#endif
-	}
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-		#ifdef __AVR_ATmega32U4__
-			TIMSK3 &= ~(1 << TOIE3);		// Disable overflow interruption when 0
-			SREG = (SREG & 0b01111111); // Disable interrupts without modifiying other interrupts
-		#else
-			TIMSK2 &= ~(1 << TOIE2);		// Disable overflow interruption when 0
-			SREG = (SREG & 0b01111111); // Disable interrupts without modifiying other interrupts
-		#endif
-
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-		if (_overflows > 0) {
-			_overflows--;
-		}
-		if (_overflows == 0 && _remaining > 0) {
-				// Load remaining count to counter
-				_loadRemaining();
-				// And clear remaining count
-				_remaining = 0;
-		} else if (_overflows == 0 && _remaining == 0) {
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
-				if (__overflows == 0) {
-					_remaining = __remaining;
-					_loadRemaining();
-					_remaining = 0;
-				} else {
-					_overflows = __overflows;
-					_remaining = __remaining;
-				}
-			}
-			_cb();
-		}
-	}
-
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	#ifdef __AVR_ATmega32U4__
-		// Arduino AVR
-		ISR(TIMER3_OVF_vect) {
-			TimerLib._interrupt();
-		}
-	#else
-		// Arduino AVR
-		ISR(TIMER2_OVF_vect) {
-			TimerLib._interrupt();
-		}
-	#endif
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.AVR.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+
+#if (defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_AVR)) && !defined(ARDUINO_attiny) && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+	#include <avr/sleep.h>
+
+	#if (UTIMERLIB_TIMERS & ~0x3EUL) || ((UTIMERLIB_TIMERS & (1UL << 2)) && !defined(TCCR2A)) || ((UTIMERLIB_TIMERS & (1UL << 3)) && !defined(TCCR3A)) || ((UTIMERLIB_TIMERS & (1UL << 4)) && (!defined(TCCR4A) || defined(__AVR_ATmega32U4__))) || ((UTIMERLIB_TIMERS & (1UL << 5)) && !defined(TCCR5A))
+		#error "uTimerLib: UTIMERLIB_TIMERS has a timer not available on this board"
+	#endif
+
+	// Timer2, 8 bit, is used by this instance; it is a constant unless UTIMERLIB_TIMERS has 8 and 16 bit timers
+	#if !(UTIMERLIB_TIMERS & (1UL << 2))
+		#define UTIMERLIB_IS_TIMER2 false
+	#elif !(UTIMERLIB_TIMERS & ~(1UL << 2))
+		#define UTIMERLIB_IS_TIMER2 true
+	#else
+		#define UTIMERLIB_IS_TIMER2 (_timer == 2)
+	#endif
+
+	/**
+	 * \brief Registers of a 16 bit timer. Timer1, 3, 4 and 5 have same layout and bit positions, so Timer1 names are used for bits
+	 */
+	struct _uTimerLibAVR16 {
+		volatile uint8_t * tccra;
+		volatile uint8_t * tccrb;
+		volatile uint8_t * timsk;
+		volatile uint8_t * tifr;
+		volatile uint16_t * tcnt;
+		volatile uint16_t * ocra;
+	};
+
+	/**
+	 * \brief Gets registers of a 16 bit timer
+	 *
+	 * @param	timer	Timer number: 1, 3, 4 or 5
+	 * @return	Timer registers
+	 */
+	static inline _uTimerLibAVR16 _avr16(unsigned char timer) {
+		switch (timer) {
+			#ifdef TCCR3A
+				case 3:
+					return {&TCCR3A, &TCCR3B, &TIMSK3, &TIFR3, &TCNT3, &OCR3A};
+			#endif
+			#if defined(TCCR4A) && !defined(__AVR_ATmega32U4__) // 32U4 Timer4 is a different 10 bit timer
+				case 4:
+					return {&TCCR4A, &TCCR4B, &TIMSK4, &TIFR4, &TCNT4, &OCR4A};
+			#endif
+			#ifdef TCCR5A
+				case 5:
+					return {&TCCR5A, &TCCR5B, &TIMSK5, &TIFR5, &TCNT5, &OCR5A};
+			#endif
+			default:
+				return {&TCCR1A, &TCCR1B, &TIMSK1, &TIFR1, &TCNT1, &OCR1A};
+		}
+	}
+
+
+	// Prescalers, as powers of 2, of CS bits values 1 and up: Timer2 and 16 bit timers
+	static const unsigned char _shifts2[] = {0, 3, 5, 6, 7, 8, 10};
+	static const unsigned char _shifts16[] = {0, 3, 6, 8, 10};
+
+
+	/**
+	 * \brief Selects hardware timer of this instance
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	timer	2 for Timer2; 1, 3, 4 or 5 for 16 bit timers
+	 */
+	void uTimerLib::_setTimer(unsigned char timer) {
+		_timer = timer;
+		_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+		unsigned long int counts, loops, top, longLoops;
+		unsigned char k;
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				// Timer2, 8 bit. Times for 16MHz, counts are calculated from real F_CPU
+				/*
+				Prescaler: TCCR2B; 3 last bits, CS20, CS21 and CS22
+				CS22	CS21	CS20	Freq		Divisor		Base Delay	Overflow delay
+				  0		  0		  0		stopped		   -		    -			    -
+				  0		  0		  1		16MHz		   1		0.0625us			   16us
+				  0		  1		  0		2MHz		   8		   0.5us			  128us
+				  0		  1		  1		500KHz		  32		     2us			  512us
+				  1		  0		  0		250KHz		  64		     4us			 1024us
+				  1		  0		  1		125KHz		 128		     8us			 2048us
+				  1		  1		  0		62.5KHz		 256		    16us			 4096us
+				  1		  1		  1		15.625KHz	1024		    64us			16384us
+				Smallest prescaler that fits whole time in one loop is used; 1024 with many loops for longer times
+				*/
+				k = _fitPrescaler(us, F_CPU, _shifts2, sizeof(_shifts2), 255, counts);
+				_splitLoops(counts, 8, loops, top, longLoops);
+				_attachInterrupt_raw(k + 1, loops, top, longLoops);
+				return;
+			}
+		#endif
+		// 16 bit timers (Timer3 on Leonardo and other 32U4 boards). Times for 16MHz, counts are calculated from real F_CPU
+		/*
+		Prescaler: TCCRnB; 3 last bits, CSn0, CSn1 and CSn2
+		CSn2	CSn1	CSn0	Freq		Divisor		Base Delay	Overflow delay
+		  0		  0		  0		stopped		   -		    -			    -
+		  0		  0		  1		16MHz		   1		0.0625us			 4096us
+		  0		  1		  0		2MHz		   8		   0.5us			32768us
+		  0		  1		  1		250KHz		  64		     4us			262144us
+		  1		  0		  0		62.5KHz		 256		    16us			1048576us
+		  1		  0		  1		15.625KHz	1024		    64us			4194304us
+		Smallest prescaler that fits whole time in one loop is used; 1024 with many loops for longer times
+		*/
+		k = _fitPrescaler(us, F_CPU, _shifts16, sizeof(_shifts16), 65535, counts);
+		_splitLoops(counts, 16, loops, top, longLoops);
+		_attachInterrupt_raw(k + 1, loops, top, longLoops);
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+		unsigned long int loops, top, longLoops;
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				#if defined(UTIMERLIB_LOW_POWER) && defined(AS2)
+					// Asynchronous 32768Hz crystal, prescaler 1024: 32 counts each second, 8s each loop, running on power-save sleep
+					_splitLoops(_longToCounts(us, 32768, 10), 8, loops, top, longLoops);
+					_slowClock = true;
+				#else
+					_splitLoops(_longToCounts(us, F_CPU, 10), 8, loops, top, longLoops);
+				#endif
+				_attachInterrupt_raw((1<<CS22) | (1<<CS21) | (1<<CS20), loops, top, longLoops);
+				return;
+			}
+		#endif
+		// Using longest mode from _us function, prescaler 1024
+		_splitLoops(_longToCounts(us, F_CPU, 10), 16, loops, top, longLoops);
+		_attachInterrupt_raw((1<<CS12) | (1<<CS10), loops, top, longLoops);
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to F_CPU / hz and its fraction kept
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			unsigned long int counts, loops, top, longLoops;
+			unsigned char k;
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					k = _fitPrescalerHz(hz, F_CPU, _shifts2, sizeof(_shifts2), 255, counts);
+					_splitLoops(counts, 8, loops, top, longLoops);
+					_attachInterrupt_raw(k + 1, loops, top, longLoops);
+					return _milliHz(F_CPU, _shifts2[k], counts, _fracNum, _fracDen);
+				}
+			#endif
+			k = _fitPrescalerHz(hz, F_CPU, _shifts16, sizeof(_shifts16), 65535, counts);
+			_splitLoops(counts, 16, loops, top, longLoops);
+			_attachInterrupt_raw(k + 1, loops, top, longLoops);
+			return _milliHz(F_CPU, _shifts16[k], counts, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer and interrupts for already calculated prescaler and loops
+	 *
+	 * Timer runs in CTC mode, so hardware restarts each loop by itself and ISR latency never adds to period.
+	 * Used by _attachInterrupt_us, _attachInterrupt_long and compile-time setInterval<> / setTimeout<>
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	CSMask		Clock select bits (prescaler)
+	 * @param	loops		Number of timer loops on each period
+	 * @param	top			TOP (counts - 1) of each loop
+	 * @param	longLoops	Number of loops, at the start of each period, with one more count
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned char CSMask, unsigned long int loops, unsigned int top, unsigned long int longLoops) {
+		unsigned char sreg = SREG;
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
+				cli();
+				__overflows = _overflows = loops;
+				__remaining = _remaining = top;
+				_longLoops = longLoops;
+				#if defined(UTIMERLIB_LOW_POWER) && defined(AS2)
+					if (_slowClock) {
+						_slowClock = false;
+						ASSR = (1<<AS2);		// 32768Hz crystal on TOSC1 / TOSC2; registers are written after it, as switching may corrupt them
+					} else {
+						ASSR &= ~(1<<AS2); 	// Internal clock
+					}
+				#else
+					ASSR &= ~(1<<AS2); 		// Internal clock
+				#endif
+				TCCR2A = (1<<WGM21);	// CTC, TOP = OCR2A, OC2A pin not used
+				TCCR2B = CSMask;		// Sets divisor
+				TCNT2 = 0;				// Clean timer count
+				_startPeriod();
+				#if defined(UTIMERLIB_LOW_POWER) && defined(AS2)
+					while (ASSR & ((1<<TCN2UB) | (1<<OCR2AUB) | (1<<TCR2AUB) | (1<<TCR2BUB)));	// Asynchronous registers take up to two clock cycles to update
+				#endif
+				TIFR2 = (1 << TOV2) | (1 << OCF2A);	// Clear pending interrupts
+				TIMSK2 |= (1 << OCIE2A);		// Enable interrupt on compare match
+				SREG = sreg;
+				return;
+			}
+		#endif
+		_uTimerLibAVR16 t = _avr16(_timer);
+		*t.timsk &= ~((1 << TOIE1) | (1 << OCIE1A));	// Disable overflow interruption when 0 + Disable interrupt on compare match
+		cli();
+		__overflows = _overflows = loops;
+		__remaining = _remaining = top;
+		_longLoops = longLoops;
+		*t.tccra = 0;				// CTC, TOP = OCRnA, OCnA pin not used
+		*t.tccrb = (1<<WGM12) | CSMask;	// Sets CTC and divisor
+		*t.tcnt = 0;				// Clean timer count
+		_startPeriod();
+		*t.tifr = (1 << TOV1) | (1 << OCF1A);	// Clear pending interrupts
+		*t.timsk |= (1 << OCIE1A);		// Enable interrupt on compare match
+		SREG = sreg;
+	}
+
+
+	#ifdef UTIMERLIB_HW_WAVE
+		/**
+		 * \brief Starts a square wave of us microseconds period on pin, toggled by timer on each compare match, without interrupt
+		 *
+		 * Pin must be OCnA output of timer, as given by digitalPinToTimer (OC2A is pin 11 on UNO, OC1A pin 9), and half period must
+		 * fit in one timer loop: 16384us on Timer2 and 4194304us on 16 bit timers at 16MHz. Timer runs in CTC mode, as usual.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	pin		Arduino pin number
+		 * @param	us		Square wave period in microseconds
+		 * @return	false if pin is not timer output or half period does not fit
+		 */
+		bool uTimerLib::_attachSquareWave(unsigned char pin, unsigned long int us) {
+			unsigned long int counts;
+			unsigned char k;
+			unsigned char sreg = SREG;
+			// Half period counts, at half clock
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					if (digitalPinToTimer(pin) != TIMER2A) {
+						return false;
+					}
+					k = _fitPrescaler(us, F_CPU / 2, _shifts2, sizeof(_shifts2), 256, counts);
+					if (counts > 256) {
+						return false;
+					}
+					_fracNum = 0; // Loops are not made longer by fraction, so every half period is equal
+					cli();
+					_attachInterrupt_raw(k + 1, 1, counts - 1, 0);
+					TIMSK2 &= ~(1 << OCIE2A);		// No interrupt
+					TCCR2A |= (1<<COM2A0);	// Toggle OC2A on compare match
+					SREG = sreg;
+					return true;
+				}
+			#endif
+			unsigned char output;
+			switch (_timer) {
+				#ifdef TCCR3A
+					case 3:
+						output = TIMER3A;
+						break;
+				#endif
+				#if defined(TCCR4A) && !defined(__AVR_ATmega32U4__)
+					case 4:
+						output = TIMER4A;
+						break;
+				#endif
+				#ifdef TCCR5A
+					case 5:
+						output = TIMER5A;
+						break;
+				#endif
+				default:
+					output = TIMER1A;
+			}
+			if (digitalPinToTimer(pin) != output) {
+				return false;
+			}
+			k = _fitPrescaler(us, F_CPU / 2, _shifts16, sizeof(_shifts16), 65536, counts);
+			if (counts > 65536) {
+				return false;
+			}
+			_fracNum = 0;
+			cli();
+			_attachInterrupt_raw(k + 1, 1, counts - 1, 0);
+			_uTimerLibAVR16 t = _avr16(_timer);
+			*t.timsk &= ~(1 << OCIE1A);		// No interrupt
+			*t.tccra = (1<<COM1A0);		// Toggle OCnA on compare match
+			SREG = sreg;
+			return true;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Prescaler is chosen again, as CS bits can be written while timer runs. Timer2 on asynchronous 32768Hz clock is not changed.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	false if period cannot be changed
+		 */
+		bool UTIMERLIB_ISR_ATTR uTimerLib::_changePeriod_us(unsigned long int us) {
+			unsigned long int counts, loops, top, longLoops, num, den;
+			unsigned char k;
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					#if defined(UTIMERLIB_LOW_POWER) && defined(AS2)
+						if (ASSR & (1<<AS2)) {
+							return false;
+						}
+					#endif
+					k = _fitPrescaler(us, F_CPU, _shifts2, sizeof(_shifts2), 255, counts, num, den);
+					_splitLoops(counts, 8, loops, top, longLoops);
+					_setNext(loops, top, longLoops, num, den, k + 1);
+					return true;
+				}
+			#endif
+			k = _fitPrescaler(us, F_CPU, _shifts16, sizeof(_shifts16), 65535, counts, num, den);
+			_splitLoops(counts, 16, loops, top, longLoops);
+			_setNext(loops, top, longLoops, num, den, k + 1);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us, with its prescaler; timer loop has just restarted
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					TCCR2B = _nextPrescaler;
+					return;
+				}
+			#endif
+			*_avr16(_timer).tccrb = (1<<WGM12) | _nextPrescaler;
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads TOP for the timer loop that is starting: one count longer for the first _periodLongLoops ones
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() {
+		unsigned int top = __remaining + ((__overflows - _overflows) < _periodLongLoops ? 1 : 0);
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				OCR2A = top;
+				return;
+			}
+		#endif
+		*_avr16(_timer).ocra = top;
+	}
+
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		_type = UTIMERLIB_TYPE_OFF;
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A));		// Disable timer interrupts
+				TCCR2A &= ~(1<<COM2A0);		// Disconnect OC2A of setSquareWave_us, giving pin back to digitalWrite
+				return;
+			}
+		#endif
+		_uTimerLibAVR16 t = _avr16(_timer);
+		*t.timsk &= ~((1 << TOIE1) | (1 << OCIE1A));		// Disable timer interrupts
+		*t.tccra &= ~(1<<COM1A0);		// Disconnect OCnA of setSquareWave_us
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * Timer2 on asynchronous 32768Hz clock (UTIMERLIB_LOW_POWER and setXXX_s) keeps running on power-save mode, so it is used;
+	 * other timers need I/O clock, so only CPU is stopped (idle mode). Any other interrupt wakes up CPU, and it sleeps again.
+	 * On power-save Timer0 is stopped too, so millis() does not advance.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		for (;;) {
+			unsigned char mode = SLEEP_MODE_IDLE;
+			#if defined(UTIMERLIB_LOW_POWER) && defined(TCCR2A) && defined(AS2)
+				if (UTIMERLIB_IS_TIMER2 && (ASSR & (1<<AS2))) {
+					// After a wake up one TOSC1 cycle must pass before power-save again: write a register and wait for its update
+					TCCR2A = TCCR2A;
+					while (ASSR & (1<<TCR2AUB));
+					mode = SLEEP_MODE_PWR_SAVE;
+				}
+			#endif
+			cli();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF || _type == UTIMERLIB_TYPE_WAVE) { // Square wave has no calls
+				sei();
+				return;
+			}
+			set_sleep_mode(mode);
+			sleep_enable();
+			sei();
+			sleep_cpu(); // Instruction after sei() always runs, so no interrupt is lost between check and sleep
+			sleep_disable();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Compare flag tells when a loop has ended while its interrupt is still pending, so that loop is counted.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		unsigned long int count;
+		bool pending;
+		unsigned char sreg = SREG;
+		cli();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			SREG = sreg;
+			return false;
+		}
+		#ifdef TCCR2A
+			if (UTIMERLIB_IS_TIMER2) {
+				count = TCNT2;
+				pending = TIFR2 & (1 << OCF2A);
+				if (pending) { // Read again, as loop may end just after first read
+					count = TCNT2;
+				}
+				hz = F_CPU >> _shifts2[(TCCR2B & 7) - 1];
+				#if defined(UTIMERLIB_LOW_POWER) && defined(AS2)
+					if (ASSR & (1<<AS2)) {
+						hz = 32768UL >> _shifts2[(TCCR2B & 7) - 1];
+					}
+				#endif
+				_loopsPosition(count, pending, elapsed, total);
+				SREG = sreg;
+				return true;
+			}
+		#endif
+		_uTimerLibAVR16 t = _avr16(_timer);
+		count = *t.tcnt;
+		pending = *t.tifr & (1 << OCF1A);
+		if (pending) { // Read again, as loop may end just after first read
+			count = *t.tcnt;
+		}
+		hz = F_CPU >> _shifts16[(*t.tccrb & 7) - 1];
+		_loopsPosition(count, pending, elapsed, total);
+		SREG = sreg;
+		return true;
+	}
+
+	#ifdef UTIMERLIB_OVERRUN
+		/**
+		 * \brief Timer interrupt already pending, called from it when timed function returns, is end of current period
+		 *
+		 * Interrupts are disabled, so compare match flag is set for at most one ended loop; it ends period when it is the last one.
+		 *
+		 * Note: This is device-dependant
+		 */
+		bool uTimerLib::_overrunPending() {
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					return _overflows == 1 && (TIFR2 & (1 << OCF2A));
+				}
+			#endif
+			return _overflows == 1 && (*_avr16(_timer).tifr & (1 << OCF1A));
+		}
+	#endif
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function counts hardware loops to offer user desired timings.
+	 * Loops are restarted by hardware, here only TOP is changed when needed.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		if (--_overflows == 0) {
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
+				#ifdef UTIMERLIB_RELOAD
+					if (_nextReady) {
+						_loadNext();
+					}
+				#endif
+				_overflows = __overflows;
+				_startPeriod();
+			}
+			_callback();
+		} else if (__overflows - _overflows == _periodLongLoops) {
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_REMAINING);
+			_loadRemaining();
+		}
+		#ifdef UTIMERLIB_TRACE
+			else {
+				_traceEvent(UTIMERLIB_TRACE_OVERFLOW);
+			}
+		#endif
+	}
+
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer prescaler, as power of 2, to convert timer counts to CPU cycles
+		 *
+		 * @param	tccrb	Timer control register B, with CS bits
+		 * @param	timer2	Timer is Timer2, with its own prescalers
+		 * @return	Prescaler as power of 2
+		 */
+		static inline unsigned char _statsShift(unsigned char tccrb, bool timer2) {
+			static const unsigned char shifts2[] = {0, 0, 3, 5, 6, 7, 8, 10};
+			static const unsigned char shifts16[] = {0, 0, 3, 6, 8, 10, 0, 0};
+			return timer2 ? shifts2[tccrb & 7] : shifts16[tccrb & 7];
+		}
+
+		/**
+		 * \brief Timer count, in CPU cycles. In CTC mode it restarts on compare match, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					return (unsigned long int) TCNT2 << _statsShift(TCCR2B, true);
+				}
+			#endif
+			_uTimerLibAVR16 t = _avr16(_timer);
+			return (unsigned long int) *t.tcnt << _statsShift(*t.tccrb, false);
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * AVR has no cycle counter, so timer count register is used.
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsCycles() {
+			return _statsLatency();
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp, up to two timer loops
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+			unsigned long int now;
+			#ifdef TCCR2A
+				if (UTIMERLIB_IS_TIMER2) {
+					now = TCNT2;
+					if (TIFR2 & (1 << OCF2A)) { // Loop ended while measuring; read again, as it may end just after first read
+						now = TCNT2 + (unsigned long int) OCR2A + 1;
+					}
+					now <<= _statsShift(TCCR2B, true);
+					return now > start ? now - start : 0;
+				}
+			#endif
+			_uTimerLibAVR16 t = _avr16(_timer);
+			now = *t.tcnt;
+			if (*t.tifr & (1 << OCF1A)) { // Loop ended while measuring; read again, as it may end just after first read
+				now = *t.tcnt + (unsigned long int) *t.ocra + 1;
+			}
+			now <<= _statsShift(*t.tccrb, false);
+			return now > start ? now - start : 0;
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+
+
+
+
+	/**
+	 * \brief Attach Interrupts using internal functionality, for each timer of UTIMERLIB_TIMERS
+	 *
+	 * Note: This is device-dependant
+	 */
+	#if UTIMERLIB_TIMERS & (1UL << 1)
+		ISR(TIMER1_COMPA_vect) {
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(1)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 2)
+		ISR(TIMER2_COMPA_vect) {
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(2)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 3)
+		ISR(TIMER3_COMPA_vect) {
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(3)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 4)
+		ISR(TIMER4_COMPA_vect) {
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(4)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 5)
+		ISR(TIMER5_COMPA_vect) {
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(5)]->_interrupt();
+		}
+	#endif
+
+#endif
+#endif
@@ -1,126 +1,539 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.ESP.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-#if (defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)) && defined(UTIMERLIB_HW_COMPILE)
-#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-		unsigned long int ms = (us / 1000) + 0.5;
-		if (ms == 0) {
-			ms = 1;
-		}
-		__overflows = _overflows = __remaining = _remaining = 0;
-		_ticker.attach_ms(ms, uTimerLib::interrupt);
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		__overflows = _overflows = __remaining = _remaining = 0;
-		_ticker.attach(s, uTimerLib::interrupt);
-	}
-
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() { }
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_ticker.detach();
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-		if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-			clearTimer();
-		}
-		_cb();
-	}
-
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::interrupt() {
-		TimerLib._interrupt();
-	}
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.ESP.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if defined(ARDUINO_ARCH_ESP8266) && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+
+	#ifndef UTIMERLIB_ESP8266_TIMER1
+		extern "C" {
+			#include "user_interface.h"
+		}
+
+		// Longest os_timer_arm wait, in ms; longer waits are armed again
+		#define UTIMERLIB_ESP8266_OS_MAX_MS 6870947UL
+
+		// OS timer shared by all uTimerLib objects, armed to nearest call, and running objects, as a linked list
+		static os_timer_t _osTimer;
+		static bool _osReady = false;
+		static uTimerLib * _osList = NULL;
+	#endif
+
+	#ifdef UTIMERLIB_ESP8266_TIMER1
+		// Timer1 input, APB clock
+		#define UTIMERLIB_ESP8266_TIMER1_HZ 80000000UL
+
+		// Timer1 is only one: uTimerLib object that started it last gets its interrupts
+		static uTimerLib * _timer1Instance = NULL;
+
+		/**
+		 * \brief Timer1 interrupt handler
+		 *
+		 * Note: This is device-dependant
+		 */
+		static void UTIMERLIB_ISR_ATTR _timer1Interrupt() {
+			_timer1Instance->_interrupt();
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_ESP8266_TIMER1
+		// Timer1 dividers and their prescalers, as powers of 2
+		static const unsigned char _timer1Shifts[] = {0, 4, 8};
+		static const unsigned char _timer1Dividers[] = {TIM_DIV1, TIM_DIV16, TIM_DIV256};
+
+		/**
+		 * \brief Smallest Timer1 divider that fits us microseconds in one loop, or TIM_DIV256
+		 *
+		 * @param	us		Time in microseconds
+		 * @return	Index of divider in _timer1Dividers
+		 */
+		static inline unsigned char UTIMERLIB_ISR_ATTR _timer1Divider(unsigned long int us) {
+			unsigned char k = 0;
+			while (k < 2 && us > (0x7FFFFFUL << _timer1Shifts[k]) / (UTIMERLIB_ESP8266_TIMER1_HZ / 1000000)) {
+				k++;
+			}
+			return k;
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			/*
+			Timer1 (FRC1), 23 bit down counter from 80MHz APB clock, whatever CPU clock is:
+
+			Name		Prescaler	Freq		Base Delay		Overflow delay
+			TIM_DIV1		1		80MHz		0,0125us		  104857,6us
+			TIM_DIV16	   16		 5MHz		0,2us			 1677721,4us
+			TIM_DIV256	  256		312,5KHz	3,2us			26843545,4us
+
+			Smallest divider that fits whole time in one loop, TIM_DIV256 and equal loops for longer times
+			*/
+			unsigned char k = _timer1Divider(us);
+			_attachInterrupt_raw(_timer1Dividers[k], _usToCounts(us, UTIMERLIB_ESP8266_TIMER1_HZ, _timer1Shifts[k]));
+		#else
+			_osStart(us);
+		#endif
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to its clock / hz
+		 *
+		 * Timer1: smallest divider that fits 80MHz / hz in one loop, rounded to nearest count, as loading it restarts the count.
+		 * OS timer: calls are kept in microseconds plus a fraction of 1 / hz us, so long-run period is exact down to 1ms.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			#ifdef UTIMERLIB_ESP8266_TIMER1
+				unsigned char k = 0;
+				while (k < 2 && UTIMERLIB_ESP8266_TIMER1_HZ / ((unsigned long long) hz << _timer1Shifts[k]) > 0x7FFFFFUL) {
+					k++;
+				}
+				unsigned long int num, den;
+				unsigned long int counts = _hzToCountsFrac(hz, UTIMERLIB_ESP8266_TIMER1_HZ, _timer1Shifts[k], num, den);
+				if (num >= den - num) { // Nearest count
+					counts++;
+				}
+				_attachInterrupt_raw(_timer1Dividers[k], counts);
+				return _milliHz(UTIMERLIB_ESP8266_TIMER1_HZ, _timer1Shifts[k], counts, 0, 1);
+			#else
+				if (hz > 1000) { // OS timer resolution
+					_osStart(1000);
+					return 1000000;
+				}
+				_osStart(1000000 / hz);
+				_fracNum = 1000000 % hz;
+				_fracDen = hz;
+				_fracErr = hz / 2;
+				return _milliHz(1000000, 0, _osPeriod, _fracNum, _fracDen);
+			#endif
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			// TIM_DIV256: 312500 counts each second
+			_attachInterrupt_raw(TIM_DIV256, _longToCounts(us, UTIMERLIB_ESP8266_TIMER1_HZ, 8));
+		#else
+			_osStart(us);
+		#endif
+	}
+
+
+	#ifndef UTIMERLIB_ESP8266_TIMER1
+		/**
+		 * \brief Starts virtual timer of this object, each us microseconds, on OS timer shared by all objects
+		 *
+		 * Calls are kept in microseconds, so long-run period is exact while each call is at ms resolution of OS timer.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		Period in microseconds; 1ms at least
+		 */
+		void uTimerLib::_osStart(unsigned long long us) {
+			_osStop();
+			__overflows = _overflows = __remaining = _remaining = 0;
+			_fracNum = 0;
+			_osPeriod = us < 1000 ? 1000 : us;
+			_osDue = micros64() + _osPeriod;
+			_osNext = _osList;
+			_osList = this;
+			_osArm();
+		}
+
+		/**
+		 * \brief Removes virtual timer of this object from running ones
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_osStop() {
+			for (uTimerLib ** t = &_osList; *t != NULL; t = &(*t)->_osNext) {
+				if (*t == this) {
+					*t = _osNext;
+					_osNext = NULL;
+					_osArm();
+					return;
+				}
+			}
+		}
+
+		/**
+		 * \brief Arms shared OS timer for nearest call of running virtual timers, or leaves it disarmed if there is none
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_osArm() {
+			if (!_osReady) {
+				_osReady = true;
+				os_timer_setfn(&_osTimer, _osTick, NULL);
+			}
+			os_timer_disarm(&_osTimer);
+			if (_osList == NULL) {
+				return;
+			}
+			unsigned long long due = _osList->_osDue;
+			for (uTimerLib * t = _osList->_osNext; t != NULL; t = t->_osNext) {
+				if (t->_osDue < due) {
+					due = t->_osDue;
+				}
+			}
+			unsigned long long now = micros64();
+			unsigned long long ms = due > now ? (due - now + 999) / 1000 : 1; // Never early
+			os_timer_arm(&_osTimer, ms < UTIMERLIB_ESP8266_OS_MAX_MS ? ms : UTIMERLIB_ESP8266_OS_MAX_MS, false);
+		}
+
+		/**
+		 * \brief Shared OS timer callback: calls every due virtual timer, then arms OS timer for next one
+		 *
+		 * OS timer callbacks and loop() run on the same SDK task, so running list needs no lock.
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_osTick(void *) {
+			for (;;) {
+				unsigned long long now = micros64();
+				uTimerLib * t = _osList;
+				while (t != NULL && t->_osDue > now) {
+					t = t->_osNext;
+				}
+				if (t == NULL) {
+					break;
+				}
+				t->_osDue += t->_osPeriod + t->_fracStep(); // Fraction is only set by setFrequency_hz
+				if (t->_osDue <= now) { // Late a whole period or more: missed calls are skipped, not queued, keeping phase
+					t->_osDue += ((now - t->_osDue) / t->_osPeriod + 1) * t->_osPeriod;
+				}
+				t->_interrupt();
+			}
+			_osArm();
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_ESP8266_TIMER1
+		/**
+		 * \brief Starts Timer1 with a period of counts, splitted in equal loops when they do not fit in 23 bits
+		 *
+		 * Timer reloads by itself each loop (TIM_LOOP), so periods do not drift. Loading counter restarts it,
+		 * so it is never reloaded inside a period: when there are several loops, long ones (one count longer)
+		 * are counted as short ones, less than 0.25ppm of error.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	divider		TIM_DIV1, TIM_DIV16 or TIM_DIV256
+		 * @param	counts		Timer counts of whole period
+		 */
+		void UTIMERLIB_ISR_ATTR uTimerLib::_attachInterrupt_raw(unsigned char divider, unsigned long long counts) {
+			unsigned long int loops, top, longLoops;
+			_splitLoops(counts ? counts : 1, 23, loops, top, longLoops);
+			__overflows = _overflows = loops;
+			__remaining = _remaining = 0;
+
+			_timer1Instance = this;
+			timer1_disable();
+			timer1_attachInterrupt(_timer1Interrupt);
+			timer1_enable(divider, TIM_EDGE, TIM_LOOP);
+			timer1_write(top + 1);
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Virtual timer next call is already set, so on OS timer new period is used from it.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	true
+		 */
+		bool UTIMERLIB_ISR_ATTR uTimerLib::_changePeriod_us(unsigned long int us) {
+			#ifdef UTIMERLIB_ESP8266_TIMER1
+				unsigned long int loops, top, longLoops;
+				unsigned char k = _timer1Divider(us);
+				_splitLoops(_usToCounts(us, UTIMERLIB_ESP8266_TIMER1_HZ, _timer1Shifts[k]), 23, loops, top, longLoops);
+				_setNext(loops, top, 0, 0, 1, _timer1Dividers[k]);
+			#else
+				_osPeriod = us < 1000 ? 1000 : us;
+				_fracNum = 0;
+			#endif
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us, with its divider
+		 *
+		 * Writing Timer1 load value restarts its count, so new period starts at this interrupt.
+		 *
+		 * Note: This is device-dependant
+		 */
+		void UTIMERLIB_ISR_ATTR uTimerLib::_loadNext() {
+			_takeNext();
+			#ifdef UTIMERLIB_ESP8266_TIMER1
+				timer1_enable(_nextPrescaler, TIM_EDGE, TIM_LOOP);
+				timer1_write(__remaining + 1);
+				__remaining = 0;
+			#endif
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() { }
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::clearTimer() {
+		_type = UTIMERLIB_TYPE_OFF;
+
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			if (_timer1Instance == this) {
+				timer1_disable();
+			}
+		#else
+			_osStop();
+		#endif
+	}
+
+	/**
+	 * \brief Waits for next timed function call
+	 *
+	 * CPU sleep is managed by ESP8266 SDK, so here it only yields to it while waiting.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		while (_calls == calls && _type != UTIMERLIB_TYPE_OFF) {
+			yield();
+		}
+	}
+
+	#ifdef UTIMERLIB_ESP8266_TIMER1
+		/**
+		 * \brief Reads position in current period, for now_ticks() and remaining_us()
+		 *
+		 * Timer1 counts down from its load value, that is one loop; loops are counted by _interrupt.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	elapsed		Returns timer counts since period started
+		 * @param	total		Returns timer counts of whole period
+		 * @param	hz			Returns timer counts per second
+		 * @return	false if timer is not running
+		 */
+		bool UTIMERLIB_ISR_ATTR uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+			static const unsigned char shifts[] = {0, 4, 8, 8}; // T1C divider bits: TIM_DIV1, TIM_DIV16, -, TIM_DIV256
+			UTIMERLIB_LOCK();
+			if (_type == UTIMERLIB_TYPE_OFF || _timer1Instance != this) {
+				UTIMERLIB_UNLOCK();
+				return false;
+			}
+			unsigned long int loop = T1L;
+			elapsed = (unsigned long long) (__overflows - _overflows) * loop + (loop - T1V);
+			total = (unsigned long long) __overflows * loop;
+			hz = UTIMERLIB_ESP8266_TIMER1_HZ >> shifts[(T1C >> 2) & 3];
+			UTIMERLIB_UNLOCK();
+			return true;
+		}
+	#else
+		/**
+		 * \brief Position in current period, from virtual timer next call and micros64(), as OS timer has no readable count
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	elapsed		Returns microseconds since period started
+		 * @param	total		Returns microseconds of whole period
+		 * @param	hz			Returns 1000000
+		 * @return	false if timer is not running
+		 */
+		bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+			if (_type == UTIMERLIB_TYPE_OFF) {
+				return false;
+			}
+			unsigned long long now = micros64();
+			total = _osPeriod;
+			elapsed = now + _osPeriod > _osDue ? now + _osPeriod - _osDue : 0;
+			if (elapsed > total) { // Call is late
+				elapsed = total;
+			}
+			hz = 1000000;
+			return true;
+		}
+	#endif
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function implements oferflow control to offer user desired timings.
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			if (--_overflows > 0) {
+				UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_OVERFLOW);
+				return;
+			}
+			#ifdef UTIMERLIB_RELOAD
+				if (_nextReady && _type == UTIMERLIB_TYPE_INTERVAL) {
+					_loadNext();
+				}
+			#endif
+			_overflows = __overflows;
+		#endif
+		if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+			clearTimer();
+		}
+		_callback();
+	}
+
+
+	#ifdef UTIMERLIB_STATS
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			/**
+			 * \brief Timer1 counts since reload, in CPU cycles, so at ISR entry it is entry latency
+			 *
+			 * Note: This is device-dependant
+			 */
+			unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsLatency() {
+				static const unsigned char shifts[] = {0, 4, 8, 8}; // T1C divider bits: TIM_DIV1, TIM_DIV16, -, TIM_DIV256
+				return ((T1L - T1V) << shifts[(T1C >> 2) & 3]) * (F_CPU / UTIMERLIB_ESP8266_TIMER1_HZ);
+			}
+		#else
+			/**
+			 * \brief ISR entry latency; not available, as OS timer has no readable count
+			 *
+			 * Note: This is device-dependant
+			 */
+			unsigned long int uTimerLib::_statsLatency() {
+				return 0;
+			}
+		#endif
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsCycles() {
+			return ESP.getCycleCount();
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsElapsed(unsigned long int start) {
+			return ESP.getCycleCount() - start;
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+#endif
+#endif
@@ -0,0 +1,361 @@
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.ESP32.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if defined(ARDUINO_ARCH_ESP32) && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+	#if (UTIMERLIB_TIMERS & ~0xFUL)
+		#error "UTIMERLIB_TIMERS: ESP32 timers are 0 to 3"
+	#endif
+	#if defined(SOC_TIMER_GROUP_TOTAL_TIMERS) && (UTIMERLIB_TIMERS >> SOC_TIMER_GROUP_TOTAL_TIMERS)
+		#error "UTIMERLIB_TIMERS: this ESP32 has not all selected timers"
+	#endif
+
+	// Arduino ESP32 core 3.x timer API: timerBegin(frequency) takes first free timer, and timerAlarm replaces timerAlarmWrite / Enable / Disable
+	#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+		#define UTIMERLIB_ESP32_V3
+	#endif
+
+	/**
+	 * \brief Sets alarm value of timer, on any core version
+	 *
+	 * @param	timer	Hardware timer
+	 * @param	alarm	Alarm, in timer counts
+	 * @param	reload	Counter is reloaded on alarm, for intervals
+	 */
+	static inline void UTIMERLIB_ISR_ATTR _esp32Alarm(hw_timer_t * timer, unsigned long long alarm, bool reload) {
+		#ifdef UTIMERLIB_ESP32_V3
+			timerAlarm(timer, alarm, reload, 0);
+		#else
+			timerAlarmWrite(timer, alarm, reload);
+		#endif
+	}
+
+
+	/**
+	 * \brief Select hardware timer, 0 to 3, and its interrupt handler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+	 */
+	void uTimerLib::_setTimer(unsigned char timer) {
+		static void (* const handlers[])() = {interrupt<0>, interrupt<1>, interrupt<2>, interrupt<3>};
+		_timer = timer;
+		_handler = handlers[timer];
+		_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+		__overflows = _overflows = __remaining = _remaining = 0;
+		_alarm = us;
+		_fracNum = 0;
+		_startAlarm();
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency: 1000000 / hz counts, plus its fraction added by _interrupt
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			__overflows = _overflows = __remaining = _remaining = 0;
+			_alarm = 1000000 / hz;
+			_fracNum = 1000000 % hz;
+			_fracDen = hz;
+			_fracErr = hz / 2;
+			_startAlarm();
+			return _milliHz(1000000, 0, _alarm, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+		__overflows = _overflows = __remaining = _remaining = 0;
+		_alarm = us;
+		_fracNum = 0;
+		_startAlarm();
+	}
+
+
+	/**
+	 * \brief Starts timer from 0 with alarm on _alarm us
+	 *
+	 * Counter is 64 bit at 1us, so any time fits in one alarm: no loops nor remaining counts are needed.
+	 * Hardware reloads counter on intervals and disables alarm after a timeout by itself.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::_startAlarm() {
+		#ifdef UTIMERLIB_ESP32_V3
+			if (_hwTimer == NULL) {
+				_hwTimer = timerBegin(1000000); // 1MHz, on first free timer
+				if (_hwTimer == NULL) { // All of them are in use
+					_type = UTIMERLIB_TYPE_OFF;
+					return;
+				}
+				timerAttachInterrupt(_hwTimer, _handler);
+			}
+			timerStop(_hwTimer);
+			timerWrite(_hwTimer, 0);
+			_esp32Alarm(_hwTimer, _alarm, _type == UTIMERLIB_TYPE_INTERVAL);
+			timerStart(_hwTimer);
+		#else
+			if (_hwTimer == NULL) {
+				_hwTimer = timerBegin(_timer, getApbFrequency() / 1000000, true); // 1MHz from APB clock
+				timerAttachInterrupt(_hwTimer, _handler, false);
+			}
+			timerAlarmDisable(_hwTimer);
+			timerWrite(_hwTimer, 0);
+			_esp32Alarm(_hwTimer, _alarm, _type == UTIMERLIB_TYPE_INTERVAL);
+			timerAlarmEnable(_hwTimer);
+		#endif
+	}
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates alarm of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	true
+		 */
+		bool UTIMERLIB_ISR_ATTR uTimerLib::_changePeriod_us(unsigned long int us) {
+			_setNext(0, us, 0, 0, 1, 0);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads alarm published by changePeriod_us; counter has just been reloaded by hardware, so it is used on this period
+		 *
+		 * Note: This is device-dependant
+		 */
+		void UTIMERLIB_ISR_ATTR uTimerLib::_loadNext() {
+			_takeNext();
+			_alarm = __remaining;
+			__remaining = 0;
+			_esp32Alarm(_hwTimer, _alarm, true);
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() { }
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::clearTimer() {
+		_type = UTIMERLIB_TYPE_OFF;
+
+		if (_hwTimer != NULL) {
+			#ifdef UTIMERLIB_ESP32_V3
+				timerStop(_hwTimer);
+			#else
+				timerAlarmDisable(_hwTimer);
+			#endif
+		}
+	}
+
+	/**
+	 * \brief Waits for next timed function call
+	 *
+	 * CPU sleep is managed by FreeRTOS idle task, so here it only yields to it while waiting.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		while (_calls == calls && _type != UTIMERLIB_TYPE_OFF) {
+			yield();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Counter runs at 1MHz and is reloaded by hardware on intervals; after a timeout it keeps counting.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool UTIMERLIB_ISR_ATTR uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		if (_type == UTIMERLIB_TYPE_OFF || _hwTimer == NULL) {
+			return false;
+		}
+		UTIMERLIB_LOCK();
+		elapsed = timerRead(_hwTimer);
+		total = _alarm;
+		UTIMERLIB_UNLOCK();
+		if (elapsed > total) {
+			elapsed = total;
+		}
+		hz = 1000000;
+		return true;
+	}
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * Each alarm is a whole period, so it only calls timed function. Alarm of an interval with a fraction,
+	 * set by setFrequency_hz, is one count longer on some periods; counter has just been reloaded, so it applies to this one.
+	 */
+	void UTIMERLIB_ISR_ATTR uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		UTIMERLIB_ISR_LOCK(); // setXXX / clearTimer / changePeriod_us may be running on the other core
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			UTIMERLIB_ISR_UNLOCK();
+			return;
+		}
+		if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+			_type = UTIMERLIB_TYPE_OFF; // Alarm is already disabled by hardware
+		}
+		#ifdef UTIMERLIB_RELOAD
+			else if (_nextReady) {
+				_loadNext();
+			}
+		#endif
+		else if (_fracNum != 0) {
+			_esp32Alarm(_hwTimer, _alarm + _fracStep(), true);
+		}
+		UTIMERLIB_ISR_UNLOCK();
+		_callback();
+	}
+
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer count since alarm, in CPU cycles, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsLatency() {
+			unsigned long long counts = timerRead(_hwTimer);
+			if (_type != UTIMERLIB_TYPE_INTERVAL) { // Not reloaded, it continues counting after alarm
+				counts -= _alarm;
+			}
+			return counts * (F_CPU / 1000000);
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsCycles() {
+			return ESP.getCycleCount();
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_statsElapsed(unsigned long int start) {
+			return ESP.getCycleCount() - start;
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+#endif
+#endif
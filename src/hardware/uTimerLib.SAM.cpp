@@ -1,235 +1,491 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.SAM.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-#if defined(ARDUINO_ARCH_SAM)  && defined(UTIMERLIB_HW_COMPILE)
-#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-
-
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-
-		/*
-		Prescalers: MCK/2, MCK/8, MCK/32, MCK/128
-		Base frequency: 84MHz
-
-		Available Timers:
-		ISR/IRQ	 TC	  Channel	Due pins
-		  TC0	TC0		0		2, 13
-		  TC1	TC0		1		60, 61
-		  TC2	TC0		2		58
-		  TC3	TC1		0		none
-		  TC4	TC1		1		none
-		  TC5	TC1		2		none
-		  TC6	TC2		0		4, 5
-		  TC7	TC2		1		3, 10
-		  TC8	TC2		2		11, 12
-
-		We will use TC1, as it has no associated pins. We will choose Channel 0, so ISR is TC3
-
-		REMEMBER! 32 bit counter!!!
-
-
-				Name				Prescaler	Freq	Base Delay		Overflow delay
-		TC_CMR_TCCLKS_TIMER_CLOCK1	  2		    42MHz   0,023809524us	102261126,913327104us, 102,261126913327104s
-		TC_CMR_TCCLKS_TIMER_CLOCK2	  8		  10.5MHz	0,095238095us	409044503,35834112us, 409,04450335834112s
-		TC_CMR_TCCLKS_TIMER_CLOCK3	 32		 2.625MHz	0,380952381us	1636178017,523809524us, 1636,178017523809524s
-		TC_CMR_TCCLKS_TIMER_CLOCK4	128		656.25KHz	1,523809524us	6544712070,913327104us, 6544,712070913327104s
-
-		For simplify things, we'll use always TC_CMR_TCCLKS_TIMER_CLOCK32,as has enougth resolution for us.
-		*/
-
-		if (us > 1636178017) {
-			__overflows = _overflows = us / 1636178017.523809524;
-			__remaining = _remaining = (us - (1636178017.523809524 * _overflows)) / 0.380952381 + 0.5; // +0.5 is same as round
-		} else {
-			__overflows = _overflows = 0;
-			__remaining = _remaining = (us / 0.380952381 + 0.5); // +0.5 is same as round
-		}
-		pmc_set_writeprotect(false); // Enable write
-		pmc_enable_periph_clk(ID_TC3); // Enable TC1 - channel 0 peripheral
-		TC_Configure(TC1, 0, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK3); // Configure clock; prescaler = 32
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			TC_SetRC(TC1, 0, 4294967295); // Int on last number
-		}
-
-		TC_Start(TC1, 0);
-		TC1->TC_CHANNEL[0].TC_IER = TC_IER_CPCS;
-		TC1->TC_CHANNEL[0].TC_IDR = ~TC_IER_CPCS;
-		NVIC_EnableIRQ(TC3_IRQn);
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		/*
-		See _ms functions for detailed info; here only selected points
-
-				Name				Prescaler	Freq	Base Delay		Overflow delay
-		TC_CMR_TCCLKS_TIMER_CLOCK4	128		656.25KHz	1,523809524us	6544712070,913327104us, 6544,712070913327104s
-
-		For simplify things, we'll use always TC_CMR_TCCLKS_TIMER_CLOCK32,as has enougth resolution for us.
-		*/
-		if (s > 6544) {
-			__overflows = _overflows = s / 6544.712070913327104;
-			__remaining = _remaining = (s - (6544.712070913327104 * _overflows) / 0.000001523809524 + 0.5); // +0.5 is same as round
-		} else {
-			__overflows = _overflows = 0;
-			__remaining = _remaining = (s / 0.000001523809524 + 0.5); // +0.5 is same as round
-		}
-
-		pmc_set_writeprotect(false); // Enable write
-		//pmc_enable_periph_clk((uint32_t) TC3_IRQn); // Enable TC1 - channel 0 peripheral
-		pmc_enable_periph_clk(ID_TC3); // Enable TC1 - channel 0 peripheral
-		TC_Configure(TC1, 0, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK4); // Configure clock; prescaler = 128
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			TC_SetRC(TC1, 0, 4294967295); // Int on last number
-		}
-
-		TC1->TC_CHANNEL[0].TC_IER=TC_IER_CPCS;
-		TC1->TC_CHANNEL[0].TC_IDR=~TC_IER_CPCS;
-		NVIC_EnableIRQ(TC3_IRQn);
-		TC_Start(TC1, 0);
-	}
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() {
-		TC_SetRC(TC1, 0, _remaining);
-	}
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-        NVIC_DisableIRQ(TC3_IRQn);
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-
-		if (_overflows > 0) {
-			_overflows--;
-		}
-		if (_overflows == 0 && _remaining > 0) {
-			// Load remaining count to counter
-			_loadRemaining();
-			// And clear remaining count
-			_remaining = 0;
-		} else if (_overflows == 0 && _remaining == 0) {
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
-				if (__overflows == 0) {
-					_remaining = __remaining;
-					_loadRemaining();
-					_remaining = 0;
-				} else {
-					_overflows = __overflows;
-					_remaining = __remaining;
-
-					TC_SetRC(TC1, 0, 4294967295);
-				}
-			}
-			_cb();
-		} else if (_overflows > 0) { // Reload for SAM
-			TC_SetRC(TC1, 0, 4294967295);
-		}
-	}
-
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	void TC3_Handler() {
-		TC_GetStatus(TC1, 0); // reset interrupt
-		TimerLib._interrupt();
-	}
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.SAM.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if defined(ARDUINO_ARCH_SAM)  && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+
+	/**
+	 * \brief TC block of timer TC0 to TC8 (ISR number); channel is timer % 3
+	 */
+	static inline Tc * _samTc(unsigned char timer) {
+		return timer < 3 ? TC0 : (timer < 6 ? TC1 : TC2);
+	}
+
+
+	/**
+	 * \brief Select hardware timer, TC0 to TC8 (ISR number), and register instance for its interrupt handler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+	 */
+	void uTimerLib::_setTimer(unsigned char timer) {
+		_timer = timer;
+		_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+	}
+
+
+	// Clocks used for us times, and their prescalers as powers of 2
+	static const unsigned char _shifts[] = {5, 7};
+	static const unsigned long int _clocks[] = {TC_CMR_TCCLKS_TIMER_CLOCK3, TC_CMR_TCCLKS_TIMER_CLOCK4};
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		/*
+		Prescalers: MCK/2, MCK/8, MCK/32, MCK/128
+		Base frequency: 84MHz
+
+		Available Timers:
+		ISR/IRQ	 TC	  Channel	Due pins
+		  TC0	TC0		0		2, 13
+		  TC1	TC0		1		60, 61
+		  TC2	TC0		2		58
+		  TC3	TC1		0		none
+		  TC4	TC1		1		none
+		  TC5	TC1		2		none
+		  TC6	TC2		0		4, 5
+		  TC7	TC2		1		3, 10
+		  TC8	TC2		2		11, 12
+
+		We use TC3 by default (TC1, channel 0), as it has no associated pins. UTIMERLIB_TIMER and constructor select another one.
+
+		REMEMBER! 32 bit counter!!!
+
+
+				Name				Prescaler	Freq	Base Delay		Overflow delay
+		TC_CMR_TCCLKS_TIMER_CLOCK1	  2		    42MHz   0,023809524us	102261126,913327104us, 102,261126913327104s
+		TC_CMR_TCCLKS_TIMER_CLOCK2	  8		  10.5MHz	0,095238095us	409044503,35834112us, 409,04450335834112s
+		TC_CMR_TCCLKS_TIMER_CLOCK3	 32		 2.625MHz	0,380952381us	1636178017,523809524us, 1636,178017523809524s
+		TC_CMR_TCCLKS_TIMER_CLOCK4	128		656.25KHz	1,523809524us	6544712070,913327104us, 6544,712070913327104s
+
+		We use TC_CMR_TCCLKS_TIMER_CLOCK3, as has enougth resolution for us, and TIMER_CLOCK4 for times not fitting in it,
+		so us times never need overflows. Counts are calculated from real VARIANT_MCK.
+		*/
+
+		// TIMER_CLOCK3 up to 1/4 of counter, plenty for us, so counts never overflow 32 bits
+		unsigned long int counts;
+		unsigned long int clock = _clocks[_fitPrescaler(us, VARIANT_MCK, _shifts, sizeof(_shifts), 0x3FFFFFFF, counts)];
+		_attachInterrupt_raw(clock, counts);
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to VARIANT_MCK / hz and its fraction kept
+		 *
+		 * All four clocks are tried, from MCK/2: any frequency from 1Hz fits in one loop, so it is always the finest one.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			static const unsigned char shifts[] = {1, 3, 5, 7};
+			static const unsigned long int clocks[] = {TC_CMR_TCCLKS_TIMER_CLOCK1, TC_CMR_TCCLKS_TIMER_CLOCK2, TC_CMR_TCCLKS_TIMER_CLOCK3, TC_CMR_TCCLKS_TIMER_CLOCK4};
+			unsigned long int counts;
+			unsigned char k = _fitPrescalerHz(hz, VARIANT_MCK, shifts, sizeof(shifts), 0x3FFFFFFF, counts);
+			_attachInterrupt_raw(clocks[k], counts);
+			return _milliHz(VARIANT_MCK, shifts[k], counts, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer and interrupts for already calculated clock and counts of each period, fitting in one loop
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	clock	TC_CMR_TCCLKS_TIMER_CLOCKx value
+	 * @param	counts	Timer counts of each period
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned long int clock, unsigned long int counts) {
+		__remaining = _remaining = counts;
+		__overflows = _overflows = 0;
+		Tc * tc = _samTc(_timer);
+		unsigned char channel = _timer % 3;
+		pmc_set_writeprotect(false); // Enable write
+		pmc_enable_periph_clk(ID_TC0 + _timer); // Enable TC block - channel peripheral
+		TC_Configure(tc, channel, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | clock); // Configure clock
+
+		if (__overflows == 0) {
+			_loadRemaining();
+			_remaining = 0;
+		} else {
+			TC_SetRC(tc, channel, 4294967295); // Int on last number
+		}
+
+		TC_Start(tc, channel);
+		tc->TC_CHANNEL[channel].TC_IER = TC_IER_CPCS;
+		tc->TC_CHANNEL[channel].TC_IDR = ~TC_IER_CPCS;
+		NVIC_EnableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		/*
+		See _ms functions for detailed info; here only selected points
+
+				Name				Prescaler	Freq	Base Delay		Overflow delay
+		TC_CMR_TCCLKS_TIMER_CLOCK4	128		656.25KHz	1,523809524us	6544712070,913327104us, 6544,712070913327104s
+
+		For simplify things, we'll use always TC_CMR_TCCLKS_TIMER_CLOCK4, as times are long.
+		*/
+		// Complete loops are 2^32 counts: RC on last number
+		unsigned long long counts = _longToCounts(us, VARIANT_MCK, 7);
+		__overflows = _overflows = counts >> 32;
+		__remaining = _remaining = counts & 0xFFFFFFFF;
+
+		Tc * tc = _samTc(_timer);
+		unsigned char channel = _timer % 3;
+		pmc_set_writeprotect(false); // Enable write
+		pmc_enable_periph_clk(ID_TC0 + _timer); // Enable TC block - channel peripheral
+		TC_Configure(tc, channel, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK4); // Configure clock; prescaler = 128
+
+		if (__overflows == 0) {
+			_loadRemaining();
+			_remaining = 0;
+		} else {
+			TC_SetRC(tc, channel, 4294967295); // Int on last number
+		}
+
+		tc->TC_CHANNEL[channel].TC_IER=TC_IER_CPCS;
+		tc->TC_CHANNEL[channel].TC_IDR=~TC_IER_CPCS;
+		NVIC_EnableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+		TC_Start(tc, channel);
+	}
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	true
+		 */
+		bool uTimerLib::_changePeriod_us(unsigned long int us) {
+			unsigned long int counts, num, den;
+			unsigned char k = _fitPrescaler(us, VARIANT_MCK, _shifts, sizeof(_shifts), 0x3FFFFFFF, counts, num, den);
+			_setNext(0, counts, 0, num, den, _clocks[k]);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us, with its clock; counter has just restarted on RC match
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+			TcChannel & channel = _samTc(_timer)->TC_CHANNEL[_timer % 3];
+			channel.TC_CMR = (channel.TC_CMR & ~TC_CMR_TCCLKS_Msk) | _nextPrescaler;
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() {
+		TC_SetRC(_samTc(_timer), _timer % 3, _remaining);
+	}
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		_type = UTIMERLIB_TYPE_OFF;
+
+        NVIC_DisableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * Timer needs peripheral clocks, so only CPU is stopped (sleep mode, WFI). Any other interrupt wakes up CPU, and it sleeps again.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		for (;;) {
+			__disable_irq();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF) {
+				__enable_irq();
+				return;
+			}
+			// WFI wakes up on pending interrupt even when they are disabled, so none is lost between check and sleep
+			__DSB();
+			__WFI();
+			__enable_irq();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Status register is cleared on read, so a loop ending while reading is not detected: period is at most one loop
+	 * for us times, that restarts counter, and long ones lose less than one loop of 2^32 counts.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		static const unsigned char shifts[] = {1, 3, 5, 7}; // TIMER_CLOCK1 to TIMER_CLOCK4: MCK/2, /8, /32 and /128
+		UTIMERLIB_LOCK();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			UTIMERLIB_UNLOCK();
+			return false;
+		}
+		TcChannel * channel = &_samTc(_timer)->TC_CHANNEL[_timer % 3];
+		unsigned long int count = channel->TC_CV;
+		hz = VARIANT_MCK >> shifts[channel->TC_CMR & 3];
+		total = ((unsigned long long) __overflows << 32) + __remaining;
+		elapsed = ((unsigned long long) (_overflows > 0 ? __overflows - _overflows : __overflows) << 32) + count;
+		UTIMERLIB_UNLOCK();
+		if (elapsed > total) {
+			elapsed = total;
+		}
+		return true;
+	}
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function implements oferflow control to offer user desired timings.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+
+		if (_overflows > 0) {
+			_overflows--;
+		}
+		if (_overflows == 0 && _remaining > 0) {
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_REMAINING);
+			// Load remaining count to counter
+			_loadRemaining();
+			// And clear remaining count
+			_remaining = 0;
+		} else if (_overflows == 0 && _remaining == 0) {
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
+				#ifdef UTIMERLIB_RELOAD
+					if (_nextReady) {
+						_loadNext();
+					}
+				#endif
+				// Fraction count is added to last loop
+				_remaining = __remaining + _fracStep();
+				if (__overflows == 0) {
+					_loadRemaining();
+					_remaining = 0;
+				} else {
+					_overflows = __overflows;
+
+					TC_SetRC(_samTc(_timer), _timer % 3, 4294967295);
+				}
+			}
+			_callback();
+		} else if (_overflows > 0) { // Reload for SAM
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_OVERFLOW);
+			TC_SetRC(_samTc(_timer), _timer % 3, 4294967295);
+		}
+	}
+
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer count, in CPU cycles. It restarts on RC compare, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			static const unsigned char shifts[] = {1, 3, 5, 7}; // TIMER_CLOCK1 to TIMER_CLOCK4: MCK/2, /8, /32 and /128
+			TcChannel * channel = &_samTc(_timer)->TC_CHANNEL[_timer % 3];
+			return channel->TC_CV << shifts[channel->TC_CMR & 3];
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsCycles() {
+			return UTIMERLIB_DWT_CYCCNT;
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+			return UTIMERLIB_DWT_CYCCNT - start;
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+
+
+	/**
+	 * \brief Attach Interrupts using internal functionality
+	 *
+	 * Note: This is device-dependant
+	 */
+	#if UTIMERLIB_TIMERS & (1UL << 0)
+		void TC0_Handler() {
+			TC_GetStatus(TC0, 0); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(0)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 1)
+		void TC1_Handler() {
+			TC_GetStatus(TC0, 1); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(1)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 2)
+		void TC2_Handler() {
+			TC_GetStatus(TC0, 2); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(2)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 3)
+		void TC3_Handler() {
+			TC_GetStatus(TC1, 0); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(3)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 4)
+		void TC4_Handler() {
+			TC_GetStatus(TC1, 1); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(4)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 5)
+		void TC5_Handler() {
+			TC_GetStatus(TC1, 2); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(5)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 6)
+		void TC6_Handler() {
+			TC_GetStatus(TC2, 0); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(6)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 7)
+		void TC7_Handler() {
+			TC_GetStatus(TC2, 1); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(7)]->_interrupt();
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 8)
+		void TC8_Handler() {
+			TC_GetStatus(TC2, 2); // reset interrupt
+			uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(8)]->_interrupt();
+		}
+	#endif
+
+#endif
+#endif
@@ -1,272 +1,721 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.SAMD21.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-#if defined(_SAMD21_) && defined(UTIMERLIB_HW_COMPILE)
-#ifndef _uTimerLib_IMP_
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-
-		/*
-		16 bit timer
-
-		Prescaler:
-		Prescalers: GCLK_TC, GCLK_TC/2, GCLK_TC/4, GCLK_TC/8, GCLK_TC/16, GCLK_TC/64, GCLK_TC/256, GCLK_TC/1024
-		Base frequency: 84MHz
-
-		We will use TCC2, as there're some models with only 3 timers (regular models have 5 TCs)
-
-		REMEMBER! 16 bit counter!!!
-
-
-		Name			Prescaler	Freq		Base Delay		Overflow delay
-		GCLK_TC			   1		 48MHz		0,020833333us	   1365,333333333us;    1,365333333333ms
-		GCLK_TC/2		   2		 24MHz		0,041666667us	   2730,666666667us;    2,730666666667ms
-		GCLK_TC/4		   4		 12MHz		0,083333333us	   5461,333333333us;    5,461333333333ms
-		GCLK_TC/8		   8		  6MHz		0,166666667us	  10922,666666667us;   10,922666666667ms
-		GCLK_TC/16		  16		  3MHz		0,333333333us	  21845,333333333us;   21,845333333333ms
-		GCLK_TC/64		  64		750KHz		1,333333333us	  87381,333311488us;   87,381333311488ms
-		GCLK_TC/256		 256		187,5KHz	5,333333333us	 349525,333311488us;  349,525333311488ms
-		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
-
-		Will be using:
-			GCLK_TC/16 for us
-			GCLK_TC/1024 for s
-		*/
-
-		// Enable clock for TC
-		REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC2_TC3)) ;
-		while (GCLK->STATUS.bit.SYNCBUSY == 1); // sync
-
-		// Disable TC
-		_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
-		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-
-		// Set Timer counter Mode to 16 bits + Set TC as normal Normal Frq + Prescaler: GCLK_TC/16
-		_TC->CTRLA.reg |= (TC_CTRLA_MODE_COUNT16 + TC_CTRLA_WAVEGEN_NFRQ + TC_CTRLA_PRESCALER_DIV16);
-		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-
-		if (us > 21845) {
-			__overflows = _overflows = us / 21845.333333333;
-			__remaining = _remaining = ((us - (21845.333333333 * _overflows)) / 0.333333333) + 0.5; // +0.5 is same as round
-		} else {
-			__overflows = _overflows = 0;
-			__remaining = _remaining = (us / 0.333333333) + 0.5; // +0.5 is same as round
-		}
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			_TC->CC[0].reg = 65535;
-			_TC->INTENSET.reg = 0;              // disable all interrupts
-			_TC->INTENSET.bit.OVF = 1;          // enable overfollow
-			// Skip: while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-		}
-
-		_TC->COUNT.reg = 0;              // Reset to 0
-
-		NVIC_EnableIRQ(TC3_IRQn);
-
-		// Enable TC
-		_TC->CTRLA.reg |= TC_CTRLA_ENABLE;
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		/*
-		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
-		*/
-
-		// Enable clock for TC
-		REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TCC2_TC3)) ;
-		while (GCLK->STATUS.bit.SYNCBUSY == 1); // sync
-
-		// Disable TC
-		_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
-		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-
-		// Set Timer counter Mode to 16 bits + Set TC as normal Normal Frq + Prescaler: GCLK_TC/1024
-		_TC->CTRLA.reg |= (TC_CTRLA_MODE_COUNT16 + TC_CTRLA_WAVEGEN_NFRQ + TC_CTRLA_PRESCALER_DIV1024);
-		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-
-		if (s > 1) {
-			__overflows = _overflows = s / 1.398101333333333;
-			__remaining = _remaining = ((s - (1.398101333333333 * _overflows)) / 0.000021333333333) + 0.5; // +0.5 is same as round
-		} else {
-			__overflows = _overflows = 0;
-			__remaining = _remaining = (s / 0.000021333333333) + 0.5; // +0.5 is same as round
-		}
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			_TC->CC[0].reg = 65535;
-			_TC->INTENSET.reg = 0;              // disable all interrupts
-			_TC->INTENSET.bit.OVF = 1;          // enable overfollow
-			// Skip: while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-		}
-
-		_TC->COUNT.reg = 0;              // Reset to 0
-
-		NVIC_EnableIRQ(TC3_IRQn);
-
-		// Enable TC
-		_TC->CTRLA.reg |= TC_CTRLA_ENABLE;
-	}
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() {
-		_TC->COUNT.reg = 0;              // Reset to 0
-		_TC->CC[0].reg = _remaining;
-		_TC->INTENSET.reg = 0;              // disable all interrupts
-		_TC->INTENSET.bit.MC0 = 1;          // enable compare match to CC0
-		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
-	}
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-		// Disable TC
-		_TC->INTENSET.reg = 0;              // disable all interrupts
-		_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
-}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-
-		if (_overflows > 0) {
-			_overflows--;
-		}
-		if (_overflows == 0 && _remaining > 0) {
-				// Load remaining count to counter
-				_loadRemaining();
-				// And clear remaining count
-				_remaining = 0;
-		} else if (_overflows == 0 && _remaining == 0) {
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
-				if (__overflows == 0) {
-					_remaining = __remaining;
-					_loadRemaining();
-					_remaining = 0;
-				} else {
-					_overflows = __overflows;
-					_remaining = __remaining;
-
-					_TC->COUNT.reg = 0;              // Reset to 0
-					_TC->INTENSET.reg = 0;              // disable all interrupts
-					_TC->INTENSET.bit.OVF = 0;          // enable overfollow
-					_TC->INTENSET.bit.MC0 = 1;          // disable compare match to CC0
-					_TC->CC[0].reg = 65535;
-				}
-			}
-			_cb();
-		} else if (_overflows > 0) { // Reload for SAMD21
-			_TC->COUNT.reg = 0;              // Reset to 0
-			_TC->INTENSET.reg = 0;              // disable all interrupts
-			_TC->INTENSET.bit.OVF = 0;          // enable overfollow
-			_TC->INTENSET.bit.MC0 = 1;          // disable compare match to CC0
-			_TC->CC[0].reg = 65535;
-		}
-	}
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	void TC3_Handler() {
-		// Overflow - Nothing, we will use compare to max value instead to unify behaviour
-		if (TimerLib._TC->INTFLAG.bit.OVF == 1) {
-			TimerLib._TC->INTFLAG.bit.OVF = 1;  // Clear flag
-			TimerLib._interrupt();
-		}
-		// Compare
-		if (TimerLib._TC->INTFLAG.bit.MC0 == 1) {
-			TimerLib._TC->INTFLAG.bit.MC0 = 1;  // Clear flag
-			TimerLib._interrupt();
-		}
-	}
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.SAMD21.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if defined(_SAMD21_) && defined(UTIMERLIB_HW_COMPILE)
+#ifndef _uTimerLib_IMP_
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+	#if (UTIMERLIB_TIMERS & ~0xF8UL)
+		#error "UTIMERLIB_TIMERS: SAMD21 timers are TC3 to TC7"
+	#endif
+	#if (UTIMERLIB_TIMERS & 0xC0UL) && !defined(TC6)
+		#error "UTIMERLIB_TIMERS: this SAMD21 has no TC6 and TC7"
+	#endif
+
+	#ifdef UTIMERLIB_SAMD_COUNT32
+		#if (UTIMERLIB_TIMERS & ~0x50UL)
+			#error "UTIMERLIB_SAMD_COUNT32: SAMD21 32 bit timers are TC4 and TC6, chained with TC5 and TC7"
+		#endif
+		// 32 bit counter, TC chained with next one; COUNT and CC0 are at same addresses than 16 bit ones
+		#define UTIMERLIB_TC_MODE TC_CTRLA_MODE_COUNT32
+		#define UTIMERLIB_TC_COUNT (((TcCount32 *) _TC)->COUNT.reg)
+		#define UTIMERLIB_TC_CC0 (((TcCount32 *) _TC)->CC[0].reg)
+	#else
+		#define UTIMERLIB_TC_MODE TC_CTRLA_MODE_COUNT16
+		#define UTIMERLIB_TC_COUNT (_TC->COUNT.reg)
+		#define UTIMERLIB_TC_CC0 (_TC->CC[0].reg)
+	#endif
+
+
+	/**
+	 * \brief Select hardware timer, TC3 to TC7, and register instance for its interrupt handler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+	 */
+	void uTimerLib::_setTimer(unsigned char timer) {
+		static Tc * const tcs[] = {
+			TC3, TC4, TC5,
+			#ifdef TC6
+				TC6, TC7
+			#endif
+		};
+		_timer = timer;
+		_TC = (TcCount16*) tcs[timer - 3];
+		_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		/*
+		16 bit timer
+
+		Prescaler:
+		Prescalers: GCLK_TC, GCLK_TC/2, GCLK_TC/4, GCLK_TC/8, GCLK_TC/16, GCLK_TC/64, GCLK_TC/256, GCLK_TC/1024
+		Base frequency: GCLK0, F_CPU (48MHz)
+
+		We use TC3 by default, as there're some models with only 3 timers (regular models have 5 TCs). UTIMERLIB_TIMER and constructor select another one.
+
+		REMEMBER! 16 bit counter!!!
+
+
+		Name			Prescaler	Freq		Base Delay		Overflow delay
+		GCLK_TC			   1		 48MHz		0,020833333us	   1365,333333333us;    1,365333333333ms
+		GCLK_TC/2		   2		 24MHz		0,041666667us	   2730,666666667us;    2,730666666667ms
+		GCLK_TC/4		   4		 12MHz		0,083333333us	   5461,333333333us;    5,461333333333ms
+		GCLK_TC/8		   8		  6MHz		0,166666667us	  10922,666666667us;   10,922666666667ms
+		GCLK_TC/16		  16		  3MHz		0,333333333us	  21845,333333333us;   21,845333333333ms
+		GCLK_TC/64		  64		750KHz		1,333333333us	  87381,333311488us;   87,381333311488ms
+		GCLK_TC/256		 256		187,5KHz	5,333333333us	 349525,333311488us;  349,525333311488ms
+		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
+
+		Will be using:
+			Smallest prescaler from GCLK_TC/16 that fits whole time in one loop, so there are no loop interrupts
+			GCLK_TC/1024 for longer times and s, so there are fewest possible loop interrupts
+			Timer runs in MFRQ mode, TOP = CC0, so hardware restarts each loop by itself
+
+		With UTIMERLIB_SAMD_COUNT32 counter is 32 bit: GCLK_TC fits 89478485us, and GCLK_TC/64 any 32 bit time, so there is always one loop
+		*/
+		#ifdef UTIMERLIB_SAMD_COUNT32
+			static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10};
+			static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV1, TC_CTRLA_PRESCALER_DIV2, TC_CTRLA_PRESCALER_DIV4, TC_CTRLA_PRESCALER_DIV8, TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+			const unsigned long int maxTop = 0xFFFFFFFF;
+		#else
+			static const unsigned char shifts[] = {4, 6, 8, 10};
+			static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+			const unsigned long int maxTop = 65535;
+		#endif
+		unsigned long int counts, loops, top, longLoops;
+		unsigned char k = _fitPrescaler(us, F_CPU, shifts, sizeof(shifts), maxTop, counts);
+		_splitLoops(counts, UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+		_attachInterrupt_raw(prescalers[k], loops, top, longLoops);
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to F_CPU / hz and its fraction kept
+		 *
+		 * Same prescalers than _attachInterrupt_us.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			#ifdef UTIMERLIB_SAMD_COUNT32
+				static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10};
+				static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV1, TC_CTRLA_PRESCALER_DIV2, TC_CTRLA_PRESCALER_DIV4, TC_CTRLA_PRESCALER_DIV8, TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+				const unsigned long int maxTop = 0xFFFFFFFF;
+			#else
+				static const unsigned char shifts[] = {4, 6, 8, 10};
+				static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+				const unsigned long int maxTop = 65535;
+			#endif
+			unsigned long int counts, loops, top, longLoops;
+			unsigned char k = _fitPrescalerHz(hz, F_CPU, shifts, sizeof(shifts), maxTop, counts);
+			_splitLoops(counts, UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_attachInterrupt_raw(prescalers[k], loops, top, longLoops);
+			return _milliHz(F_CPU, shifts[k], counts, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		/*
+		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
+		32 bit counter:	1024		46.875Hz	21,333333333us	91625968981us; 91625,968981s
+		*/
+
+		unsigned long int loops, top, longLoops;
+		#ifdef UTIMERLIB_LOW_POWER
+			// 32768Hz generator, prescaler 1024: 32 counts each second, 2048s each loop, running on standby sleep
+			_splitLoops(_longToCounts(us, 32768, 10), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_slowClock = true;
+		#else
+			_splitLoops(_longToCounts(us, F_CPU, 10), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+		#endif
+		_attachInterrupt_raw(TC_CTRLA_PRESCALER_DIV1024, loops, top, longLoops);
+	}
+
+
+	/**
+	 * \brief Sets up the timer and interrupts for already calculated prescaler and loops
+	 *
+	 * Timer runs in MFRQ mode, so hardware restarts each loop by itself and ISR latency never adds to period.
+	 * Used by _attachInterrupt_us, _attachInterrupt_long and compile-time setInterval<> / setTimeout<>
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	prescaler	TC_CTRLA_PRESCALER_DIVx value
+	 * @param	loops		Number of timer loops on each period
+	 * @param	top			TOP (counts - 1) of each loop
+	 * @param	longLoops	Number of loops, at the start of each period, with one more count
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned long int prescaler, unsigned long int loops, unsigned long int top, unsigned long int longLoops) {
+		// Enable clock for TC; TC4 & TC5 and TC6 & TC7 share it
+		static const unsigned char clocks[] = {
+			GCM_TCC2_TC3, GCM_TC4_TC5, GCM_TC4_TC5,
+			#ifdef TC6
+				GCM_TC6_TC7, GCM_TC6_TC7
+			#endif
+		};
+		unsigned char generator = 0; // GCLK0, F_CPU
+		uint16_t standby = 0;
+		#ifdef UTIMERLIB_LOW_POWER
+			if (_slowClock) {
+				_slowClock = false;
+				// 32768Hz generator running on standby, from crystal when board has it, as core does for GCLK1; set up once
+				static bool ready = false;
+				if (!ready) {
+					ready = true;
+					#ifdef CRYSTALLESS
+						const uint32_t source = GCLK_GENCTRL_SRC_OSCULP32K;
+					#else
+						SYSCTRL->XOSC32K.bit.RUNSTDBY = 1;
+						const uint32_t source = GCLK_GENCTRL_SRC_XOSC32K;
+					#endif
+					GCLK->GENDIV.reg = GCLK_GENDIV_ID(UTIMERLIB_LOW_POWER_GCLK); // Not divided
+					while (GCLK->STATUS.bit.SYNCBUSY == 1); // sync
+					GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(UTIMERLIB_LOW_POWER_GCLK) | source | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_RUNSTDBY;
+					while (GCLK->STATUS.bit.SYNCBUSY == 1); // sync
+				}
+				generator = UTIMERLIB_LOW_POWER_GCLK;
+				standby = TC_CTRLA_RUNSTDBY;
+			}
+		#endif
+		if (generator != _clockGen) { // Peripheral clock is kept between periods, so it is only written when it changes
+			_clockGen = generator;
+			REG_GCLK_CLKCTRL = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(generator) | GCLK_CLKCTRL_ID(clocks[_timer - 3])) ;
+			while (GCLK->STATUS.bit.SYNCBUSY == 1); // sync
+		}
+
+		// Disable TC
+		_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+		while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
+
+		// Set Timer counter Mode to 16 or 32 bits + Set TC as Match Frequency (TOP = CC0) + Prescaler
+		// Next synchronized writes (COUNT, CC0) stall bus by themselves while this one ends, so there is no wait loop
+		_TC->CTRLA.reg = (_TC->CTRLA.reg & ~(TC_CTRLA_MODE_Msk | TC_CTRLA_WAVEGEN_Msk | TC_CTRLA_PRESCALER_Msk | TC_CTRLA_RUNSTDBY)) | UTIMERLIB_TC_MODE | TC_CTRLA_WAVEGEN_MFRQ | prescaler | standby;
+
+		__overflows = _overflows = loops;
+		__remaining = _remaining = top;
+		_longLoops = longLoops;
+
+		UTIMERLIB_TC_COUNT = 0;          // Reset to 0
+		_loadedTop = 0xFFFFFFFF;         // CC0 is always written for first loop
+		_startPeriod();
+		_TC->READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(0x10); // Continuous COUNT read synchronization, so reads need no wait
+		_TC->INTENSET.reg = 0;              // disable all interrupts
+		_TC->INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_OVF;	// clear pending ones
+		_TC->INTENSET.bit.MC0 = 1;          // enable compare match to CC0, end of each loop
+
+		NVIC_EnableIRQ((IRQn_Type) (TC3_IRQn + _timer - 3));
+
+		// Enable TC
+		_TC->CTRLA.reg |= TC_CTRLA_ENABLE;
+	}
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Prescaler is enable-protected, so running one is kept and only loops and TOP change; no register is written here.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	false if its counts do not fit in 32 bits at running prescaler
+		 */
+		bool uTimerLib::_changePeriod_us(unsigned long int us) {
+			static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10}; // GCLK_TC/1 to GCLK_TC/1024
+			unsigned long int hz = F_CPU;
+			#ifdef UTIMERLIB_LOW_POWER
+				if (_TC->CTRLA.reg & TC_CTRLA_RUNSTDBY) { // On 32768Hz generator
+					hz = 32768;
+				}
+			#endif
+			unsigned char shift = shifts[_TC->CTRLA.bit.PRESCALER];
+			if ((((unsigned long long) us * hz) >> shift) / 1000000 > 0xFFFFFFFFULL) {
+				return false;
+			}
+			unsigned long int num, den, loops, top, longLoops;
+			_splitLoops(_usToCountsFrac(us, hz, shift, num, den), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_setNext(loops, top, longLoops, num, den, 0);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us; its TOP is loaded by _startPeriod
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads TOP for the timer loop that is starting: one count longer for the first _periodLongLoops ones
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() {
+		unsigned long int top = __remaining + ((__overflows - _overflows) < _periodLongLoops ? 1 : 0);
+		if (top != _loadedTop) { // Usual one loop periods keep same TOP, so there is no synchronized write
+			_loadedTop = top;
+			UTIMERLIB_TC_CC0 = top;
+		}
+	}
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		#ifdef UTIMERLIB_SAMPLING
+			if (_type == UTIMERLIB_TYPE_SAMPLING) {
+				_stopSampling();
+			}
+		#endif
+		_type = UTIMERLIB_TYPE_OFF;
+
+		// Disable TC
+		_TC->INTENCLR.reg = TC_INTENCLR_MC0 | TC_INTENCLR_OVF;              // disable all interrupts
+		_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * TC on 32768Hz generator (UTIMERLIB_LOW_POWER and setXXX_s) keeps running on standby, so it is used; with GCLK0 only CPU
+	 * is stopped (idle mode). Any other interrupt wakes up CPU, and it sleeps again. SysTick and USB stop on standby.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		if (_TC->CTRLA.reg & TC_CTRLA_RUNSTDBY) {
+			NVMCTRL->CTRLB.bit.SLEEPPRM = NVMCTRL_CTRLB_SLEEPPRM_DISABLED_Val; // Errata: flash may not wake up from standby otherwise
+			SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+		} else {
+			SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+			PM->SLEEP.reg = PM_SLEEP_IDLE_CPU;
+		}
+		for (;;) {
+			__disable_irq();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF) {
+				__enable_irq();
+				break;
+			}
+			// WFI wakes up on pending interrupt even when they are disabled, so none is lost between check and sleep
+			__DSB();
+			__WFI();
+			__enable_irq();
+		}
+		SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Compare flag tells when a loop has ended while its interrupt is still pending, so that loop is counted.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10}; // GCLK_TC/1 to GCLK_TC/1024
+		UTIMERLIB_LOCK();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			UTIMERLIB_UNLOCK();
+			return false;
+		}
+		unsigned long int count = UTIMERLIB_TC_COUNT; // Continuously synchronized by _attachInterrupt_raw
+		bool pending = _TC->INTFLAG.bit.MC0;
+		if (pending) { // Read again, synchronized now, as loop may end just after first read
+			_TC->READREQ.reg = TC_READREQ_RREQ | TC_READREQ_RCONT | TC_READREQ_ADDR(0x10);
+			while (_TC->STATUS.bit.SYNCBUSY == 1);
+			count = UTIMERLIB_TC_COUNT;
+		}
+		hz = F_CPU;
+		#ifdef UTIMERLIB_LOW_POWER
+			if (_TC->CTRLA.reg & TC_CTRLA_RUNSTDBY) { // On 32768Hz generator
+				hz = 32768;
+			}
+		#endif
+		hz >>= shifts[_TC->CTRLA.bit.PRESCALER];
+		_loopsPosition(count, pending, elapsed, total);
+		UTIMERLIB_UNLOCK();
+		return true;
+	}
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function counts hardware loops to offer user desired timings.
+	 * Loops are restarted by hardware, here only TOP is changed when needed.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		if (--_overflows == 0) {
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
+				#ifdef UTIMERLIB_RELOAD
+					if (_nextReady) {
+						_loadNext();
+					}
+				#endif
+				_overflows = __overflows;
+				_startPeriod();
+			}
+			_callback();
+		} else if (__overflows - _overflows == _periodLongLoops) {
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_REMAINING);
+			_loadRemaining();
+		}
+		#ifdef UTIMERLIB_TRACE
+			else {
+				_traceEvent(UTIMERLIB_TRACE_OVERFLOW);
+			}
+		#endif
+	}
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer count, in CPU cycles. It restarts on CC0 match, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10}; // GCLK_TC/1 to GCLK_TC/1024
+			// COUNT is continuously synchronized by _attachInterrupt_raw, so interrupt does not wait for a read request
+			return (unsigned long int) UTIMERLIB_TC_COUNT << shifts[_TC->CTRLA.bit.PRESCALER];
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * Cortex-M0+ has no DWT cycle counter, so SysTick, running at F_CPU and reloaded each ms by core, is used.
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsCycles() {
+			return SysTick->LOAD - SysTick->VAL;
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp, up to two SysTick reloads (2ms)
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+			unsigned long int now = _statsCycles();
+			if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) { // Reloaded while measuring; read again, as it may reload just after first read
+				now = _statsCycles() + SysTick->LOAD + 1;
+			}
+			return now > start ? now - start : 0;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_SAMPLING
+		// DMA descriptors, for channels up to UTIMERLIB_DMA_CHANNEL, and second half of sampling ring
+		static __attribute__((aligned(16))) DmacDescriptor _dmaDescriptors[UTIMERLIB_DMA_CHANNEL + 1];
+		static __attribute__((aligned(16))) DmacDescriptor _dmaWriteback[UTIMERLIB_DMA_CHANNEL + 1];
+		static __attribute__((aligned(16))) DmacDescriptor _dmaSecond;
+		// DMA channel is only one: uTimerLib object sampling gets its interrupts
+		static uTimerLib * _dmaInstance = NULL;
+		// ADC setup overwritten while sampling
+		static uint16_t _adcCtrlb;
+		static uint8_t _adcSampctrl;
+
+		/**
+		 * \brief Samples an analog pin each us microseconds, without CPU: TC starts ADC through event system and DMA stores results
+		 *
+		 * Buffer is filled as a ring, and each time a half of it is full cb is called with it, from DMA interrupt,
+		 * while DMA fills the other half. Samples are 12 bit. clearTimer() stops it.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	pin		Analog pin
+		 * @param	buffer	Samples buffer
+		 * @param	length	Buffer length, in samples; must be even
+		 * @param	cb		Function called with each filled half of buffer and its length
+		 * @param	us		Sampling period in microseconds; must fit in one timer loop (1398101us on 16 bit mode), and ADC needs about 6us for each sample
+		 * @return	false if it cannot be started: wrong arguments, too long period or DMA used by other code
+		 */
+		bool uTimerLib::setSampling_us(unsigned char pin, uint16_t * buffer, unsigned int length, void (* cb)(uint16_t *, unsigned int), unsigned long int us) {
+			if (buffer == NULL || length < 2 || (length & 1) || cb == NULL || us == 0) {
+				return false;
+			}
+			if (DMAC->CTRL.bit.DMAENABLE && DMAC->BASEADDR.reg != (uint32_t) _dmaDescriptors) { // Used by other code
+				return false;
+			}
+			clearTimer();
+			analogRead(pin); // Sets pin as analog input and selects its ADC channel
+
+			// Timer, as an interval but without interrupts
+			_attachInterrupt_us(us);
+			if (__overflows != 1) { // More than one timer loop needs interrupts
+				clearTimer();
+				return false;
+			}
+			_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+			while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
+			_TC->INTENCLR.reg = TC_INTENCLR_MC0 | TC_INTENCLR_OVF;
+			_TC->EVCTRL.reg = TC_EVCTRL_OVFEO; // Event on each period end, TOP = CC0
+			NVIC_DisableIRQ((IRQn_Type) (TC3_IRQn + _timer - 3));
+
+			_type = UTIMERLIB_TYPE_SAMPLING;
+			_dmaBuffer = buffer;
+			_dmaHalf = length / 2;
+			_dmaNext = 0;
+			_dmaCb = cb;
+			_dmaInstance = this;
+
+			// ADC, started by event: 1.5MHz clock from 48MHz GCLK0, 12 bit, short sampling time, so it takes about 6us
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			ADC->CTRLA.bit.ENABLE = 0;
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			_adcCtrlb = ADC->CTRLB.reg;
+			_adcSampctrl = ADC->SAMPCTRL.reg;
+			ADC->CTRLB.reg = ADC_CTRLB_PRESCALER_DIV32 | ADC_CTRLB_RESSEL_12BIT;
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			ADC->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN(2);
+			ADC->EVCTRL.reg = ADC_EVCTRL_STARTEI;
+			ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+
+			// Event system: TC overflow to ADC start
+			static const unsigned char generators[] = {
+				EVSYS_ID_GEN_TC3_OVF, EVSYS_ID_GEN_TC4_OVF, EVSYS_ID_GEN_TC5_OVF,
+				#ifdef TC6
+					EVSYS_ID_GEN_TC6_OVF, EVSYS_ID_GEN_TC7_OVF
+				#endif
+			};
+			PM->APBCMASK.reg |= PM_APBCMASK_EVSYS;
+			EVSYS->USER.reg = EVSYS_USER_CHANNEL(UTIMERLIB_EVSYS_CHANNEL + 1) | EVSYS_USER_USER(EVSYS_ID_USER_ADC_START);
+			EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(UTIMERLIB_EVSYS_CHANNEL) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS | EVSYS_CHANNEL_EVGEN(generators[_timer - 3]);
+
+			// DMA: each ADC result to buffer, as a ring of two blocks; interrupt on each block end
+			PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+			PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+			DMAC->BASEADDR.reg = (uint32_t) _dmaDescriptors;
+			DMAC->WRBADDR.reg = (uint32_t) _dmaWriteback;
+			DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+			DmacDescriptor * first = &_dmaDescriptors[UTIMERLIB_DMA_CHANNEL];
+			first->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BLOCKACT_INT | DMAC_BTCTRL_BEATSIZE_HWORD | DMAC_BTCTRL_DSTINC;
+			first->BTCNT.reg = _dmaHalf;
+			first->SRCADDR.reg = (uint32_t) &ADC->RESULT.reg;
+			first->DSTADDR.reg = (uint32_t) (buffer + _dmaHalf); // End address, as it increments
+			first->DESCADDR.reg = (uint32_t) &_dmaSecond;
+			_dmaSecond.BTCTRL.reg = first->BTCTRL.reg;
+			_dmaSecond.BTCNT.reg = _dmaHalf;
+			_dmaSecond.SRCADDR.reg = first->SRCADDR.reg;
+			_dmaSecond.DSTADDR.reg = (uint32_t) (buffer + length);
+			_dmaSecond.DESCADDR.reg = (uint32_t) first;
+
+			DMAC->CHID.reg = DMAC_CHID_ID(UTIMERLIB_DMA_CHANNEL);
+			DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+			DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+			while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+			DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(ADC_DMAC_ID_RESRDY) | DMAC_CHCTRLB_TRIGACT_BEAT;
+			DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+			DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+			NVIC_EnableIRQ(DMAC_IRQn);
+
+			ADC->CTRLA.bit.ENABLE = 1;
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+
+			UTIMERLIB_TC_COUNT = 0;
+			_TC->CTRLA.reg |= TC_CTRLA_ENABLE;
+			return true;
+		}
+
+		/**
+		 * \brief Stops ADC, event and DMA of sampling mode, restoring ADC for analogRead
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_stopSampling() {
+			_TC->CTRLA.reg &= ~TC_CTRLA_ENABLE;
+			while (_TC->STATUS.bit.SYNCBUSY == 1); // sync
+			_TC->EVCTRL.reg = 0;
+
+			EVSYS->USER.reg = EVSYS_USER_CHANNEL(0) | EVSYS_USER_USER(EVSYS_ID_USER_ADC_START);
+
+			DMAC->CHID.reg = DMAC_CHID_ID(UTIMERLIB_DMA_CHANNEL);
+			DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+			DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL;
+			_dmaInstance = NULL;
+
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			ADC->CTRLA.bit.ENABLE = 0;
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			ADC->EVCTRL.reg = 0;
+			ADC->CTRLB.reg = _adcCtrlb;
+			while (ADC->STATUS.bit.SYNCBUSY == 1); // sync
+			ADC->SAMPCTRL.reg = _adcSampctrl;
+		}
+
+		/**
+		 * \brief DMA interrupt: end of each half of sampling buffer
+		 *
+		 * Note: This is device-dependant
+		 */
+		void DMAC_Handler() {
+			unsigned char channel = DMAC->CHID.reg;
+			DMAC->CHID.reg = DMAC_CHID_ID(UTIMERLIB_DMA_CHANNEL);
+			bool done = DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL;
+			DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+			DMAC->CHID.reg = channel;
+			if (done && _dmaInstance != NULL) {
+				_dmaInstance->_dmaInterrupt();
+			}
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+
+
+	/**
+	 * \brief Attach Interrupts using internal functionality
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	instance	uTimerLib using the TC
+	 */
+	static inline void _tcInterrupt(uTimerLib * instance) {
+		// Compare to CC0, end of each loop
+		if (instance->_TC->INTFLAG.bit.MC0 == 1) {
+			instance->_TC->INTFLAG.reg = TC_INTFLAG_MC0;  // Clear flag
+			instance->_interrupt();
+		}
+	}
+
+	#if UTIMERLIB_TIMERS & (1UL << 3)
+		void TC3_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(3)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 4)
+		void TC4_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(4)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 5)
+		void TC5_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(5)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 6)
+		void TC6_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(6)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 7)
+		void TC7_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(7)]);
+		}
+	#endif
+
+#endif
+#endif
@@ -1,282 +1,767 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.SAMD51.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-#if defined(__SAMD51__) && defined(UTIMERLIB_HW_COMPILE)
-#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-	#define UTIMERLIB_WAIT_SYNC() while (TC1->COUNT16.SYNCBUSY.reg)
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-		/*
-		16 bit timer
-
-		Prescaler:
-		Prescalers: GCLK_TC, GCLK_TC/2, GCLK_TC/4, GCLK_TC/8, GCLK_TC/16, GCLK_TC/64, GCLK_TC/256, GCLK_TC/1024
-		Base frequency: 84MHz
-
-		We will use TC1
-
-		REMEMBER! 16 bit counter!!!
-
-		Name			Prescaler	Freq		Base Delay		Overflow delay
-		GCLK_TC			   1		 120MHz		0,008333333us	    546,133333333us;    0,546133333333ms
-		GCLK_TC/2		   2		  60MHz		0,016666667us	   1092,266666667us;    1,092266666667ms
-		GCLK_TC/4		   4		  30MHz		0,033333333us	   2184,533333333us;    2,184533333333ms
-		GCLK_TC/8		   8		  20MHz		0,066666667us	   4369,066666667us;    4,369066666667ms
-		GCLK_TC/16		  16		  10MHz		0,133333333us	   8738,133333333us;    8,738133333333ms
-		GCLK_TC/64		  64		1,875MHz	0,533333333us	  34952,533333333us;   34,952533333333ms
-		GCLK_TC/256		 256		468,75KHz	2,133333333us	 139810,133333333us;  139,810133333333ms
-		GCLK_TC/1024	1024		117,1875Hz	8,533333333us	 559240,533333333us;  559,240533333333ms
-
-		Will be using:
-			GCLK_TC/16 for us
-			GCLK_TC/1024 for s
-		*/
-
-
-/*
-		// Enable the TC bus clock
-		MCLK->APBAMASK.bit.TC1_ = 1;
-		GCLK->PCHCTRL[TC1_GCLK_ID].bit.GEN = 0;
-		GCLK->PCHCTRL[TC1_GCLK_ID].bit.CHEN = 1;
-*/
-		// Enable the TC bus clock
-		GCLK->PCHCTRL[TC1_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1_Val | GCLK_PCHCTRL_CHEN;
-		while(GCLK->SYNCBUSY.reg); // sync
-
-		TC1->COUNT16.CTRLA.bit.ENABLE = 0;
-		UTIMERLIB_WAIT_SYNC();
-
-		TC1->COUNT16.CTRLA.bit.MODE = TC_CTRLA_MODE_COUNT16_Val;
-		UTIMERLIB_WAIT_SYNC();
-
-
-
-		TC1->COUNT16.CTRLA.reg &= ((~(TC_CTRLA_ENABLE)) & (~(TC_CTRLA_PRESCALER_DIV1024)) & (~(TC_CTRLA_PRESCALER_DIV256)) & (~(TC_CTRLA_PRESCALER_DIV64)) & (~(TC_CTRLA_PRESCALER_DIV16)) & (~(TC_CTRLA_PRESCALER_DIV4)) & (~(TC_CTRLA_PRESCALER_DIV2)) & (~(TC_CTRLA_PRESCALER_DIV1)));
-		UTIMERLIB_WAIT_SYNC();
-
-		TC1->COUNT16.CTRLA.reg |= TC_CTRLA_PRESCALER_DIV16;
-		UTIMERLIB_WAIT_SYNC();
-
-
-		if (us > 8738) {
-			__overflows = _overflows = us / 8738.133333333;
-			__remaining = _remaining = (us - (8738.133333333 * _overflows)) / 0.133333333 + 0.5; // +0.5 is same as round
-		} else {
-			__overflows = _overflows = 0;
-			__remaining = _remaining = (us / 0.133333333 + 0.5); // +0.5 is same as round
-		}
-
-		if (__remaining != 0) {
-			__remaining = _remaining = (((uint16_t) 0xffff) - __remaining); // Remaining is max value minus remaining
-		}
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			TC1->COUNT16.COUNT.reg = 0;
-		}
-
-
-		TC1->COUNT16.INTENSET.reg = 0;
-		TC1->COUNT16.INTENSET.bit.OVF = 1;
-		// Enable InterruptVector
-		NVIC_EnableIRQ(TC1_IRQn);
-
-		// Count on event
-		//TC1->COUNT16.EVCTRL.bit.EVACT = TC_EVCTRL_EVACT_COUNT_Val;
-
-		TC1->COUNT16.CTRLA.bit.ENABLE = 1;
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		/*
-		GCLK_TC/1024	1024		117,1875Hz	8,533333333us	 559240,533333333us;  559,240533333333ms
-		*/
-
-
-
-
-		// Enable the TC bus clock
-		GCLK->PCHCTRL[TC1_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK1_Val | GCLK_PCHCTRL_CHEN;
-		while(GCLK->SYNCBUSY.reg); // sync
-
-		TC1->COUNT16.CTRLA.bit.ENABLE = 0;
-		UTIMERLIB_WAIT_SYNC();
-
-		TC1->COUNT16.CTRLA.bit.MODE = TC_CTRLA_MODE_COUNT16_Val;
-		UTIMERLIB_WAIT_SYNC();
-
-
-
-		TC1->COUNT16.CTRLA.reg &= ((~(TC_CTRLA_ENABLE)) & (~(TC_CTRLA_PRESCALER_DIV1024)) & (~(TC_CTRLA_PRESCALER_DIV256)) & (~(TC_CTRLA_PRESCALER_DIV64)) & (~(TC_CTRLA_PRESCALER_DIV16)) & (~(TC_CTRLA_PRESCALER_DIV4)) & (~(TC_CTRLA_PRESCALER_DIV2)) & (~(TC_CTRLA_PRESCALER_DIV1)));
-		UTIMERLIB_WAIT_SYNC();
-
-		TC1->COUNT16.CTRLA.reg |= TC_CTRLA_PRESCALER_DIV1024;
-		UTIMERLIB_WAIT_SYNC();
-
-
-		__overflows = _overflows = s / 0.559240533333333;
-		__remaining = _remaining = (s - (0.559240533333333 * _overflows)) / 0.000008533333333 + 0.5; // +0.5 is same as round
-
-		if (__remaining != 0) {
-			__remaining = _remaining = (((uint16_t) 0xffff) - __remaining); // Remaining is max value minus remaining
-		}
-
-		if (__overflows == 0) {
-			_loadRemaining();
-			_remaining = 0;
-		} else {
-			TC1->COUNT16.COUNT.reg = 0;
-		}
-
-
-		TC1->COUNT16.INTENSET.reg = 0;
-		TC1->COUNT16.INTENSET.bit.OVF = 1;
-		// Enable InterruptVector
-		NVIC_EnableIRQ(TC1_IRQn);
-
-		// Count on event
-		//TC1->COUNT16.EVCTRL.bit.EVACT = TC_EVCTRL_EVACT_COUNT_Val;
-
-		TC1->COUNT16.CTRLA.bit.ENABLE = 1;
-	}
-
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() {
-		TC1->COUNT16.COUNT.reg = _remaining;
-	}
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-		TC1->COUNT16.INTENSET.reg = 0;
-		// Disable InterruptVector
-		NVIC_DisableIRQ(TC1_IRQn);
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-		if (_overflows > 0) {
-			_overflows--;
-		}
-		if (_overflows == 0 && _remaining > 0) {
-				// Load remaining count to counter
-				_loadRemaining();
-				// And clear remaining count
-				_remaining = 0;
-		} else if (_overflows == 0 && _remaining == 0) {
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
-				if (__overflows == 0) {
-					_remaining = __remaining;
-					_loadRemaining();
-					_remaining = 0;
-				} else {
-					_overflows = __overflows;
-					_remaining = __remaining;
-				}
-			}
-			_cb();
-		}
-	}
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-
-
-
-
-	/**
-	 * \brief Attach Interrupts using internal functionality
-	 *
-	 * Note: This is device-dependant
-	 */
-	void TC1_Handler() {
-		if (TC1->COUNT16.INTFLAG.bit.OVF == 1) {
-			TC1->COUNT16.INTENSET.bit.OVF = 1;  // Clear flag
-			TimerLib._interrupt();
-		}
-		if (TC1->COUNT16.INTFLAG.bit.MC0 == 1) {
-			TC1->COUNT16.INTENSET.bit.MC0 = 1;  // Clear flag
-		}
-	}
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.SAMD51.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if defined(__SAMD51__) && defined(UTIMERLIB_HW_COMPILE)
+#if	!defined(_uTimerLib_IMP_) && defined(_uTimerLib_cpp_)
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+	#if (UTIMERLIB_TIMERS & ~0xFFUL)
+		#error "UTIMERLIB_TIMERS: SAMD51 timers are TC0 to TC7"
+	#endif
+	#if ((UTIMERLIB_TIMERS & 0x30UL) && !defined(TC4)) || ((UTIMERLIB_TIMERS & 0xC0UL) && !defined(TC6))
+		#error "UTIMERLIB_TIMERS: this SAMD51 has not all selected TCs"
+	#endif
+
+	#ifdef UTIMERLIB_SAMD_COUNT32
+		#if (UTIMERLIB_TIMERS & ~0x55UL)
+			#error "UTIMERLIB_SAMD_COUNT32: SAMD51 32 bit timers are TC0, TC2, TC4 and TC6, chained with next odd TC"
+		#endif
+		// 32 bit counter, TC chained with next one; COUNT and CC0 are at same addresses than 16 bit ones
+		#define UTIMERLIB_TC_MODE TC_CTRLA_MODE_COUNT32
+		#define UTIMERLIB_TC_COUNT (((TcCount32 *) _TC)->COUNT.reg)
+		#define UTIMERLIB_TC_CC0 (((TcCount32 *) _TC)->CC[0].reg)
+	#else
+		#define UTIMERLIB_TC_MODE TC_CTRLA_MODE_COUNT16
+		#define UTIMERLIB_TC_COUNT (_TC->COUNT.reg)
+		#define UTIMERLIB_TC_CC0 (_TC->CC[0].reg)
+	#endif
+
+	#define UTIMERLIB_WAIT_SYNC() while (_TC->SYNCBUSY.reg)
+
+
+	/**
+	 * \brief Select hardware timer, TC0 to TC7, and register instance for its interrupt handler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+	 */
+	void uTimerLib::_setTimer(unsigned char timer) {
+		static Tc * const tcs[] = {
+			TC0, TC1, TC2, TC3,
+			#ifdef TC4
+				TC4, TC5,
+			#endif
+			#ifdef TC6
+				TC6, TC7
+			#endif
+		};
+		_timer = timer;
+		_TC = &tcs[timer]->COUNT16;
+		_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+	}
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+		/*
+		16 bit timer
+
+		Prescaler:
+		Prescalers: GCLK_TC, GCLK_TC/2, GCLK_TC/4, GCLK_TC/8, GCLK_TC/16, GCLK_TC/64, GCLK_TC/256, GCLK_TC/1024
+		Base frequency: GCLK1, UTIMERLIB_SAMD51_GCLK_HZ (48MHz)
+
+		We use TC1 by default. UTIMERLIB_TIMER and constructor select another one.
+
+		REMEMBER! 16 bit counter!!!
+
+		Name			Prescaler	Freq		Base Delay		Overflow delay
+		GCLK_TC			   1		 48MHz		0,020833333us	   1365,333333333us;    1,365333333333ms
+		GCLK_TC/2		   2		 24MHz		0,041666667us	   2730,666666667us;    2,730666666667ms
+		GCLK_TC/4		   4		 12MHz		0,083333333us	   5461,333333333us;    5,461333333333ms
+		GCLK_TC/8		   8		  6MHz		0,166666667us	  10922,666666667us;   10,922666666667ms
+		GCLK_TC/16		  16		  3MHz		0,333333333us	  21845,333333333us;   21,845333333333ms
+		GCLK_TC/64		  64		750KHz		1,333333333us	  87381,333311488us;   87,381333311488ms
+		GCLK_TC/256		 256		187,5KHz	5,333333333us	 349525,333311488us;  349,525333311488ms
+		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
+
+		Will be using:
+			Smallest prescaler from GCLK_TC/16 that fits whole time in one loop, so there are no loop interrupts
+			GCLK_TC/1024 for longer times and s, so there are fewest possible loop interrupts
+			Timer runs in MFRQ mode, TOP = CC0, so hardware restarts each loop by itself
+
+		With UTIMERLIB_SAMD_COUNT32 counter is 32 bit: GCLK_TC fits 89478485us, and GCLK_TC/64 any 32 bit time, so there is always one loop
+		*/
+		#ifdef UTIMERLIB_SAMD_COUNT32
+			static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10};
+			static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV1, TC_CTRLA_PRESCALER_DIV2, TC_CTRLA_PRESCALER_DIV4, TC_CTRLA_PRESCALER_DIV8, TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+			const unsigned long int maxTop = 0xFFFFFFFF;
+		#else
+			static const unsigned char shifts[] = {4, 6, 8, 10};
+			static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+			const unsigned long int maxTop = 65535;
+		#endif
+		unsigned long int counts, loops, top, longLoops;
+		unsigned char k = _fitPrescaler(us, UTIMERLIB_SAMD51_GCLK_HZ, shifts, sizeof(shifts), maxTop, counts);
+		_splitLoops(counts, UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+		_attachInterrupt_raw(prescalers[k], loops, top, longLoops);
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with counts fitted to UTIMERLIB_SAMD51_GCLK_HZ / hz and its fraction kept
+		 *
+		 * Same prescalers than _attachInterrupt_us.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			#ifdef UTIMERLIB_SAMD_COUNT32
+				static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10};
+				static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV1, TC_CTRLA_PRESCALER_DIV2, TC_CTRLA_PRESCALER_DIV4, TC_CTRLA_PRESCALER_DIV8, TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+				const unsigned long int maxTop = 0xFFFFFFFF;
+			#else
+				static const unsigned char shifts[] = {4, 6, 8, 10};
+				static const unsigned long int prescalers[] = {TC_CTRLA_PRESCALER_DIV16, TC_CTRLA_PRESCALER_DIV64, TC_CTRLA_PRESCALER_DIV256, TC_CTRLA_PRESCALER_DIV1024};
+				const unsigned long int maxTop = 65535;
+			#endif
+			unsigned long int counts, loops, top, longLoops;
+			unsigned char k = _fitPrescalerHz(hz, UTIMERLIB_SAMD51_GCLK_HZ, shifts, sizeof(shifts), maxTop, counts);
+			_splitLoops(counts, UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_attachInterrupt_raw(prescalers[k], loops, top, longLoops);
+			return _milliHz(UTIMERLIB_SAMD51_GCLK_HZ, shifts[k], counts, _fracNum, _fracDen);
+		}
+	#endif
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for long us microseconds times, with biggest prescaler
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		/*
+		GCLK_TC/1024	1024		46.875Hz	21,333333333us	1398101,333333333us; 1398,101333333333ms; 1,398101333333333s
+		32 bit counter:	1024		46.875Hz	21,333333333us	91625968981us; 91625,968981s
+		*/
+		unsigned long int loops, top, longLoops;
+		#ifdef UTIMERLIB_LOW_POWER
+			// 32768Hz generator, prescaler 1024: 32 counts each second, 2048s each loop, running on standby sleep
+			_splitLoops(_longToCounts(us, 32768, 10), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_slowClock = true;
+		#else
+			_splitLoops(_longToCounts(us, UTIMERLIB_SAMD51_GCLK_HZ, 10), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+		#endif
+		_attachInterrupt_raw(TC_CTRLA_PRESCALER_DIV1024, loops, top, longLoops);
+	}
+
+
+	/**
+	 * \brief Sets up the timer and interrupts for already calculated prescaler and loops
+	 *
+	 * Timer runs in MFRQ mode, so hardware restarts each loop by itself and ISR latency never adds to period.
+	 * Used by _attachInterrupt_us, _attachInterrupt_long and compile-time setInterval<> / setTimeout<>
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	prescaler	TC_CTRLA_PRESCALER_DIVx value
+	 * @param	loops		Number of timer loops on each period
+	 * @param	top			TOP (counts - 1) of each loop
+	 * @param	longLoops	Number of loops, at the start of each period, with one more count
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned long int prescaler, unsigned long int loops, unsigned long int top, unsigned long int longLoops) {
+/*
+		// Enable the TC bus clock
+		MCLK->APBAMASK.bit.TC1_ = 1;
+		GCLK->PCHCTRL[TC1_GCLK_ID].bit.GEN = 0;
+		GCLK->PCHCTRL[TC1_GCLK_ID].bit.CHEN = 1;
+*/
+		// Enable the TC bus clock; TCs are paired on peripheral clocks
+		static const unsigned char clocks[] = {
+			TC0_GCLK_ID, TC1_GCLK_ID, TC2_GCLK_ID, TC3_GCLK_ID,
+			#ifdef TC4
+				TC4_GCLK_ID, TC5_GCLK_ID,
+			#endif
+			#ifdef TC6
+				TC6_GCLK_ID, TC7_GCLK_ID
+			#endif
+		};
+		unsigned char generator = GCLK_PCHCTRL_GEN_GCLK1_Val;
+		bool standby = false;
+		#ifdef UTIMERLIB_LOW_POWER
+			if (_slowClock) {
+				_slowClock = false;
+				// 32768Hz generator running on standby, from crystal when board has it, as core does for GCLK3; set up once
+				static bool ready = false;
+				if (!ready) {
+					ready = true;
+					#ifdef CRYSTALLESS
+						const uint32_t source = GCLK_GENCTRL_SRC_OSCULP32K;
+					#else
+						OSC32KCTRL->XOSC32K.bit.RUNSTDBY = 1;
+						const uint32_t source = GCLK_GENCTRL_SRC_XOSC32K;
+					#endif
+					GCLK->GENCTRL[UTIMERLIB_LOW_POWER_GCLK].reg = source | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_RUNSTDBY | GCLK_GENCTRL_DIV(1);
+					while(GCLK->SYNCBUSY.reg); // sync
+				}
+				generator = UTIMERLIB_LOW_POWER_GCLK;
+				standby = true;
+			}
+		#endif
+		if (generator != _clockGen) { // Peripheral channel is kept between periods, so it is only written when it changes
+			_clockGen = generator;
+			GCLK->PCHCTRL[clocks[_timer]].reg = generator | GCLK_PCHCTRL_CHEN;
+			while(GCLK->SYNCBUSY.reg); // sync
+		}
+
+		_TC->CTRLA.bit.ENABLE = 0;
+		UTIMERLIB_WAIT_SYNC();
+
+		// Mode, prescaler and standby are enable-protected, not synchronized, so they are written at once while TC is disabled
+		_TC->CTRLA.reg = (_TC->CTRLA.reg & ~(TC_CTRLA_MODE_Msk | TC_CTRLA_PRESCALER_Msk | TC_CTRLA_RUNSTDBY)) | UTIMERLIB_TC_MODE | prescaler | (standby ? TC_CTRLA_RUNSTDBY : 0);
+
+		// Match Frequency: TOP = CC0
+		_TC->WAVE.reg = TC_WAVE_WAVEGEN_MFRQ;
+
+		__overflows = _overflows = loops;
+		__remaining = _remaining = top;
+		_longLoops = longLoops;
+
+		// COUNT and CC0 have their own synchronization, each one written once, so there is no need to wait for them
+		UTIMERLIB_TC_COUNT = 0;
+		_loadedTop = 0xFFFFFFFF;	// CC0 is always written for first loop
+		_startPeriod();
+
+		_TC->INTENCLR.reg = TC_INTENCLR_MASK;
+		_TC->INTFLAG.reg = TC_INTFLAG_MASK;	// Clear pending interrupts
+		_TC->INTENSET.reg = TC_INTENSET_MC0;	// Compare to CC0, end of each loop
+		// Enable InterruptVector
+		NVIC_EnableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+
+		// Count on event
+		//TC1->COUNT16.EVCTRL.bit.EVACT = TC_EVCTRL_EVACT_COUNT_Val;
+
+		_TC->CTRLA.bit.ENABLE = 1;
+	}
+
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Calculates reload values of a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Prescaler is enable-protected, so running one is kept and only loops and TOP change; no register is written here.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	false if its counts do not fit in 32 bits at running prescaler
+		 */
+		bool uTimerLib::_changePeriod_us(unsigned long int us) {
+			static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10}; // GCLK_TC/1 to GCLK_TC/1024
+			unsigned long int hz = UTIMERLIB_SAMD51_GCLK_HZ;
+			#ifdef UTIMERLIB_LOW_POWER
+				if (_TC->CTRLA.bit.RUNSTDBY) { // On 32768Hz generator
+					hz = 32768;
+				}
+			#endif
+			unsigned char shift = shifts[_TC->CTRLA.bit.PRESCALER];
+			if ((((unsigned long long) us * hz) >> shift) / 1000000 > 0xFFFFFFFFULL) {
+				return false;
+			}
+			unsigned long int num, den, loops, top, longLoops;
+			_splitLoops(_usToCountsFrac(us, hz, shift, num, den), UTIMERLIB_SAMD_BITS, loops, top, longLoops);
+			_setNext(loops, top, longLoops, num, den, 0);
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us; its TOP is loaded by _startPeriod
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads TOP for the timer loop that is starting: one count longer for the first _periodLongLoops ones
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() {
+		unsigned long int top = __remaining + ((__overflows - _overflows) < _periodLongLoops ? 1 : 0);
+		if (top != _loadedTop) { // Usual one loop periods keep same TOP, so there is no synchronized write
+			_loadedTop = top;
+			UTIMERLIB_TC_CC0 = top;
+		}
+	}
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		#ifdef UTIMERLIB_SAMPLING
+			if (_type == UTIMERLIB_TYPE_SAMPLING) {
+				_stopSampling();
+			}
+		#endif
+		_type = UTIMERLIB_TYPE_OFF;
+
+		_TC->INTENCLR.reg = TC_INTENCLR_MASK;
+		// Disable InterruptVector
+		NVIC_DisableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * TC on 32768Hz generator (UTIMERLIB_LOW_POWER and setXXX_s) keeps running on standby, so it is used; with GCLK1 only CPU
+	 * is stopped (idle mode). Any other interrupt wakes up CPU, and it sleeps again. SysTick and USB stop on standby.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		unsigned char mode = _TC->CTRLA.bit.RUNSTDBY ? PM_SLEEPCFG_SLEEPMODE_STANDBY_Val : PM_SLEEPCFG_SLEEPMODE_IDLE_Val;
+		PM->SLEEPCFG.reg = mode;
+		while (PM->SLEEPCFG.bit.SLEEPMODE != mode); // Must be read back before sleeping
+		for (;;) {
+			__disable_irq();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF) {
+				__enable_irq();
+				return;
+			}
+			// WFI wakes up on pending interrupt even when they are disabled, so none is lost between check and sleep
+			__DSB();
+			__WFI();
+			__enable_irq();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Compare flag tells when a loop has ended while its interrupt is still pending, so that loop is counted.
+	 * COUNT is read with READSYNC, busy-waiting on SYNCBUSY up to 5 GCLK_TC cycles each read (0.1us at 48MHz, 150us on
+	 * 32768Hz generator of UTIMERLIB_LOW_POWER) with interrupts disabled, twice when a loop has just ended.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		static const unsigned char shifts[] = {0, 1, 2, 3, 4, 6, 8, 10}; // GCLK_TC/1 to GCLK_TC/1024
+		UTIMERLIB_LOCK();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			UTIMERLIB_UNLOCK();
+			return false;
+		}
+		_TC->CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC; // Request COUNT read
+		UTIMERLIB_WAIT_SYNC();
+		unsigned long int count = UTIMERLIB_TC_COUNT;
+		bool pending = _TC->INTFLAG.bit.MC0;
+		if (pending) { // Read again, as loop may end just after first read
+			_TC->CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+			UTIMERLIB_WAIT_SYNC();
+			count = UTIMERLIB_TC_COUNT;
+		}
+		hz = UTIMERLIB_SAMD51_GCLK_HZ;
+		#ifdef UTIMERLIB_LOW_POWER
+			if (_TC->CTRLA.bit.RUNSTDBY) { // On 32768Hz generator
+				hz = 32768;
+			}
+		#endif
+		hz >>= shifts[_TC->CTRLA.bit.PRESCALER];
+		_loopsPosition(count, pending, elapsed, total);
+		UTIMERLIB_UNLOCK();
+		return true;
+	}
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function counts hardware loops to offer user desired timings.
+	 * Loops are restarted by hardware, here only TOP is changed when needed.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		if (--_overflows == 0) {
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			} else if (_type == UTIMERLIB_TYPE_INTERVAL) {
+				#ifdef UTIMERLIB_RELOAD
+					if (_nextReady) {
+						_loadNext();
+					}
+				#endif
+				_overflows = __overflows;
+				_startPeriod();
+			}
+			_callback();
+		} else if (__overflows - _overflows == _periodLongLoops) {
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_REMAINING);
+			_loadRemaining();
+		}
+		#ifdef UTIMERLIB_TRACE
+			else {
+				_traceEvent(UTIMERLIB_TRACE_OVERFLOW);
+			}
+		#endif
+	}
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief ISR entry latency; not measured, as reading COUNT needs a READSYNC command and a SYNCBUSY busy-wait of up to
+		 * 5 GCLK_TC cycles on each interrupt. Always 0, as on ESP8266
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			return 0;
+		}
+
+		/**
+		 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsCycles() {
+			return UTIMERLIB_DWT_CYCCNT;
+		}
+
+		/**
+		 * \brief CPU cycles since a _statsCycles time stamp
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	start	Time stamp
+		 * @return	Elapsed CPU cycles
+		 */
+		unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+			return UTIMERLIB_DWT_CYCCNT - start;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_SAMPLING
+		#if UTIMERLIB_DMA_CHANNEL > 3
+			#error "UTIMERLIB_DMA_CHANNEL: SAMD51 has interrupt handlers only for DMA channels 0 to 3"
+		#endif
+
+		// DMA descriptors, for channels up to UTIMERLIB_DMA_CHANNEL, and second half of sampling ring
+		static __attribute__((aligned(16))) DmacDescriptor _dmaDescriptors[UTIMERLIB_DMA_CHANNEL + 1];
+		static __attribute__((aligned(16))) DmacDescriptor _dmaWriteback[UTIMERLIB_DMA_CHANNEL + 1];
+		static __attribute__((aligned(16))) DmacDescriptor _dmaSecond;
+		// DMA channel is only one: uTimerLib object sampling gets its interrupts
+		static uTimerLib * _dmaInstance = NULL;
+		// ADC used by sampled pin, and its setup overwritten while sampling
+		static Adc * _adc = NULL;
+		static unsigned char _adcUser;
+		static uint8_t _adcPrescaler;
+		static uint16_t _adcCtrlb;
+		static uint8_t _adcSampctrl;
+
+		#define UTIMERLIB_WAIT_ADC_SYNC() while (_adc->SYNCBUSY.reg)
+
+		/**
+		 * \brief Samples an analog pin each us microseconds, without CPU: TC starts ADC through event system and DMA stores results
+		 *
+		 * Buffer is filled as a ring, and each time a half of it is full cb is called with it, from DMA interrupt,
+		 * while DMA fills the other half. Samples are 12 bit. clearTimer() stops it.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	pin		Analog pin, on ADC0 or ADC1
+		 * @param	buffer	Samples buffer
+		 * @param	length	Buffer length, in samples; must be even
+		 * @param	cb		Function called with each filled half of buffer and its length
+		 * @param	us		Sampling period in microseconds; must fit in one timer loop (1398101us on 16 bit mode), and ADC needs about 2us for each sample
+		 * @return	false if it cannot be started: wrong arguments, not analog pin, too long period or DMA used by other code
+		 */
+		bool uTimerLib::setSampling_us(unsigned char pin, uint16_t * buffer, unsigned int length, void (* cb)(uint16_t *, unsigned int), unsigned long int us) {
+			if (buffer == NULL || length < 2 || (length & 1) || cb == NULL || us == 0) {
+				return false;
+			}
+			unsigned long int attributes = g_APinDescription[pin].ulPinAttribute;
+			if ((attributes & (PIN_ATTR_ANALOG | PIN_ATTR_ANALOG_ALT)) == 0) {
+				return false;
+			}
+			if (DMAC->CTRL.bit.DMAENABLE && DMAC->BASEADDR.reg != (uint32_t) _dmaDescriptors) { // Used by other code
+				return false;
+			}
+			clearTimer();
+			analogRead(pin); // Sets pin as analog input and selects its ADC channel
+
+			// Timer, as an interval but without interrupts
+			_attachInterrupt_us(us);
+			if (__overflows != 1) { // More than one timer loop needs interrupts
+				clearTimer();
+				return false;
+			}
+			_TC->CTRLA.bit.ENABLE = 0;
+			UTIMERLIB_WAIT_SYNC();
+			_TC->INTENCLR.reg = TC_INTENCLR_MASK;
+			_TC->EVCTRL.reg = TC_EVCTRL_OVFEO; // Event on each period end, TOP = CC0
+			NVIC_DisableIRQ((IRQn_Type) (TC0_IRQn + _timer));
+
+			_type = UTIMERLIB_TYPE_SAMPLING;
+			_dmaBuffer = buffer;
+			_dmaHalf = length / 2;
+			_dmaNext = 0;
+			_dmaCb = cb;
+			_dmaInstance = this;
+
+			// ADC, same one analogRead uses for the pin, started by event: 12MHz clock from 48MHz GCLK1, 12 bit, so it takes about 2us
+			bool alt = (attributes & PIN_ATTR_ANALOG) == 0;
+			_adc = alt ? ADC1 : ADC0;
+			_adcUser = alt ? EVSYS_ID_USER_ADC1_START : EVSYS_ID_USER_ADC0_START;
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->CTRLA.bit.ENABLE = 0;
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adcPrescaler = _adc->CTRLA.bit.PRESCALER;
+			_adcCtrlb = _adc->CTRLB.reg;
+			_adcSampctrl = _adc->SAMPCTRL.reg;
+			_adc->CTRLA.bit.PRESCALER = ADC_CTRLA_PRESCALER_DIV4_Val;
+			_adc->CTRLB.reg = ADC_CTRLB_RESSEL_12BIT;
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN(5);
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->EVCTRL.reg = ADC_EVCTRL_STARTEI;
+			_adc->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+
+			// Event system: TC overflow to ADC start
+			static const unsigned char generators[] = {
+				EVSYS_ID_GEN_TC0_OVF, EVSYS_ID_GEN_TC1_OVF, EVSYS_ID_GEN_TC2_OVF, EVSYS_ID_GEN_TC3_OVF,
+				#ifdef TC4
+					EVSYS_ID_GEN_TC4_OVF, EVSYS_ID_GEN_TC5_OVF,
+				#endif
+				#ifdef TC6
+					EVSYS_ID_GEN_TC6_OVF, EVSYS_ID_GEN_TC7_OVF
+				#endif
+			};
+			MCLK->APBBMASK.reg |= MCLK_APBBMASK_EVSYS;
+			EVSYS->USER[_adcUser].reg = EVSYS_USER_CHANNEL(UTIMERLIB_EVSYS_CHANNEL + 1);
+			EVSYS->Channel[UTIMERLIB_EVSYS_CHANNEL].CHANNEL.reg = EVSYS_CHANNEL_EVGEN(generators[_timer]) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+
+			// DMA: each ADC result to buffer, as a ring of two blocks; interrupt on each block end
+			MCLK->AHBMASK.reg |= MCLK_AHBMASK_DMAC;
+			DMAC->BASEADDR.reg = (uint32_t) _dmaDescriptors;
+			DMAC->WRBADDR.reg = (uint32_t) _dmaWriteback;
+			DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+			DmacDescriptor * first = &_dmaDescriptors[UTIMERLIB_DMA_CHANNEL];
+			first->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BLOCKACT_INT | DMAC_BTCTRL_BEATSIZE_HWORD | DMAC_BTCTRL_DSTINC;
+			first->BTCNT.reg = _dmaHalf;
+			first->SRCADDR.reg = (uint32_t) &_adc->RESULT.reg;
+			first->DSTADDR.reg = (uint32_t) (buffer + _dmaHalf); // End address, as it increments
+			first->DESCADDR.reg = (uint32_t) &_dmaSecond;
+			_dmaSecond.BTCTRL.reg = first->BTCTRL.reg;
+			_dmaSecond.BTCNT.reg = _dmaHalf;
+			_dmaSecond.SRCADDR.reg = first->SRCADDR.reg;
+			_dmaSecond.DSTADDR.reg = (uint32_t) (buffer + length);
+			_dmaSecond.DESCADDR.reg = (uint32_t) first;
+
+			DmacChannel * channel = &DMAC->Channel[UTIMERLIB_DMA_CHANNEL];
+			channel->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+			channel->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+			while (channel->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+			channel->CHCTRLA.reg = DMAC_CHCTRLA_TRIGSRC(alt ? ADC1_DMAC_ID_RESRDY : ADC0_DMAC_ID_RESRDY) | DMAC_CHCTRLA_TRIGACT_BURST | DMAC_CHCTRLA_BURSTLEN_SINGLE;
+			channel->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+			channel->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+			NVIC_EnableIRQ((IRQn_Type) (DMAC_0_IRQn + UTIMERLIB_DMA_CHANNEL));
+
+			_adc->CTRLA.bit.ENABLE = 1;
+			UTIMERLIB_WAIT_ADC_SYNC();
+
+			UTIMERLIB_TC_COUNT = 0;
+			UTIMERLIB_WAIT_SYNC();
+			_TC->CTRLA.bit.ENABLE = 1;
+			return true;
+		}
+
+		/**
+		 * \brief Stops ADC, event and DMA of sampling mode, restoring ADC for analogRead
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_stopSampling() {
+			_TC->CTRLA.bit.ENABLE = 0;
+			UTIMERLIB_WAIT_SYNC();
+			_TC->EVCTRL.reg = 0;
+
+			EVSYS->USER[_adcUser].reg = 0;
+
+			DMAC->Channel[UTIMERLIB_DMA_CHANNEL].CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+			DMAC->Channel[UTIMERLIB_DMA_CHANNEL].CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL;
+			_dmaInstance = NULL;
+
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->CTRLA.bit.ENABLE = 0;
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->EVCTRL.reg = 0;
+			_adc->CTRLA.bit.PRESCALER = _adcPrescaler;
+			_adc->CTRLB.reg = _adcCtrlb;
+			UTIMERLIB_WAIT_ADC_SYNC();
+			_adc->SAMPCTRL.reg = _adcSampctrl;
+			UTIMERLIB_WAIT_ADC_SYNC();
+		}
+
+		#define UTIMERLIB_DMAC_HANDLER_NAME(channel) DMAC_##channel##_Handler
+		#define UTIMERLIB_DMAC_HANDLER(channel) UTIMERLIB_DMAC_HANDLER_NAME(channel)
+
+		/**
+		 * \brief DMA channel interrupt: end of each half of sampling buffer
+		 *
+		 * Note: This is device-dependant
+		 */
+		void UTIMERLIB_DMAC_HANDLER(UTIMERLIB_DMA_CHANNEL)() {
+			DmacChannel * channel = &DMAC->Channel[UTIMERLIB_DMA_CHANNEL];
+			bool done = channel->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL;
+			channel->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+			if (done && _dmaInstance != NULL) {
+				_dmaInstance->_dmaInterrupt();
+			}
+		}
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+
+
+
+
+	/**
+	 * \brief Attach Interrupts using internal functionality
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	instance	uTimerLib using the TC
+	 */
+	static inline void _tcInterrupt(uTimerLib * instance) {
+		// Compare to CC0, end of each loop
+		if (instance->_TC->INTFLAG.bit.MC0 == 1) {
+			instance->_TC->INTFLAG.reg = TC_INTFLAG_MC0;  // Clear flag
+			instance->_interrupt();
+		}
+	}
+
+	#if UTIMERLIB_TIMERS & (1UL << 0)
+		void TC0_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(0)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 1)
+		void TC1_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(1)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 2)
+		void TC2_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(2)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 3)
+		void TC3_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(3)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 4)
+		void TC4_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(4)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 5)
+		void TC5_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(5)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 6)
+		void TC6_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(6)]);
+		}
+	#endif
+	#if UTIMERLIB_TIMERS & (1UL << 7)
+		void TC7_Handler() {
+			_tcInterrupt(uTimerLib::_instances[UTIMERLIB_TIMER_INDEX(7)]);
+		}
+	#endif
+
+#endif
+#endif
@@ -1,194 +1,631 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file hardware/uTimerLib.STM32.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-#if (defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)) && defined(UTIMERLIB_HW_COMPILE)
-#ifndef _uTimerLib_IMP_
-	#define _uTimerLib_IMP_
-	#include "uTimerLib.cpp"
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	us		Desired timing in microseconds
-	 */
-	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
-		if (us == 0) { // Not valid
-			return;
-		}
-
-		// STM32, all variants - Max us is: uint32 max / CYCLES_PER_MICROSECOND
-		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-		#ifdef BOARD_NAME
-			Timer3->setMode(1, TIMER_OUTPUT_COMPARE);
-			__overflows = _overflows = __remaining = _remaining = 0;
-			Timer3->setOverflow(us, MICROSEC_FORMAT);
-			Timer3->setCaptureCompare(1, us, MICROSEC_COMPARE_FORMAT);
-			if (_toInit) {
-				_toInit = false;
-				Timer3->attachInterrupt((uint32_t) 1, uTimerLib::interrupt);
-			}
-			Timer3->resume();
-
-		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-		#else
-			Timer3.setMode(TIMER_CH1, TIMER_OUTPUTCOMPARE);
-			__overflows = _overflows = __remaining = _remaining = 0;
-			uint16_t timerOverflow = Timer3.setPeriod(us);
-			Timer3.setCompare(TIMER_CH1, timerOverflow);
-			if (_toInit) {
-				_toInit = false;
-				Timer3.attachInterrupt(TIMER_CH1, uTimerLib::interrupt);
-			}
-			Timer3.refresh();
-			Timer3.resume();
-		#endif
-	}
-
-
-	/**
-	 * \brief Sets up the timer, calculation variables and interrupts for desired s seconds
-	 *
-	 * Note: This is device-dependant
-	 *
-	 * @param	s		Desired timing in seconds
-	 */
-	void uTimerLib::_attachInterrupt_s(unsigned long int s) {
-		if (s == 0) { // Not valid
-			return;
-		}
-
-		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-		#ifdef BOARD_NAME
-			Timer3->setMode(1, TIMER_OUTPUT_COMPARE);
-			__overflows = _overflows = s;
-			__remaining = _remaining = 0;
-			Timer3->setOverflow((unsigned long int) 1000000, MICROSEC_FORMAT);
-			Timer3->setCaptureCompare(1, (unsigned long int) 1000000, MICROSEC_COMPARE_FORMAT);
-			if (_toInit) {
-				_toInit = false;
-				Timer3->attachInterrupt((uint32_t) 1, uTimerLib::interrupt);
-			}
-			Timer3->resume();
-
-		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-		#else
-			Timer3.setMode(TIMER_CH1, TIMER_OUTPUTCOMPARE);
-			Timer3.setPeriod((uint32) 1000000);
-			Timer3.setCompare(TIMER_CH1, 0);
-			Timer3.setCount(1);
-			__overflows = _overflows = s;
-			__remaining = _remaining = 0;
-			if (_toInit) {
-				_toInit = false;
-				Timer3.attachInterrupt(TIMER_CH1, uTimerLib::interrupt);
-			}
-			Timer3.refresh();
-			Timer3.resume();
-		#endif
-	}
-
-
-
-	/**
-	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::_loadRemaining() { }
-
-	/**
-	 * \brief Clear timer interrupts
-	 *
-	 * Note: This is device-dependant
-	 */
-	void uTimerLib::clearTimer() {
-		_type = UTIMERLIB_TYPE_OFF;
-
-		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-		#ifdef BOARD_NAME
-			Timer3->pause();
-
-		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-		#else
-			Timer3.pause();
-		#endif
-	}
-
-	/**
-	 * \brief Internal intermediate function to control timer interrupts
-	 *
-	 * As timers doesn't give us enougth flexibility for large timings,
-	 * this function implements oferflow control to offer user desired timings.
-	 */
-	void uTimerLib::_interrupt() {
-		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
-			return;
-		}
-		// We are making X overflows, as much as seconds (none on us). So wee compare upper than 1
-		if (_overflows > 1) {
-			_overflows--;
-		} else {
-			_overflows = __overflows;
-			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
-				clearTimer();
-			}
-			_cb();
-		}
-	}
-
-	/**
-	 * \brief Static envelope for Internal intermediate function to control timer interrupts
-	 */
-	// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-	#ifdef BOARD_NAME
-		callback_function_t uTimerLib::interrupt() {
-			_instance->_interrupt();
-		}
-
-	// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-	#else
-		void uTimerLib::interrupt() {
-			_instance->_interrupt();
-		}
-	#endif
-
-
-
-	/**
-	 * \brief Preinstantiate Object
-	 *
-	 * Now you can use al functionality calling Timerlib.function
-	 */
-	uTimerLib TimerLib = uTimerLib();
-
-#endif
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file hardware/uTimerLib.STM32.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+#if (defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)) && defined(UTIMERLIB_HW_COMPILE)
+#ifndef _uTimerLib_IMP_
+	#define _uTimerLib_IMP_
+	#include "uTimerLib.cpp"
+
+	// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+	#ifdef BOARD_NAME
+		#if (UTIMERLIB_TIMERS & ~0x3FFFEUL)
+			#error "UTIMERLIB_TIMERS: STM32 timers are TIM1 to TIM17"
+		#endif
+
+		/**
+		 * \brief Timer peripheral TIM1 to TIM17, TIM3 if not available
+		 */
+		static TIM_TypeDef * _stm32Tim(unsigned char timer) {
+			switch (timer) {
+			#ifdef TIM1
+				case 1: return TIM1;
+			#endif
+			#ifdef TIM2
+				case 2: return TIM2;
+			#endif
+			#ifdef TIM4
+				case 4: return TIM4;
+			#endif
+			#ifdef TIM5
+				case 5: return TIM5;
+			#endif
+			#ifdef TIM6
+				case 6: return TIM6;
+			#endif
+			#ifdef TIM7
+				case 7: return TIM7;
+			#endif
+			#ifdef TIM8
+				case 8: return TIM8;
+			#endif
+			#ifdef TIM9
+				case 9: return TIM9;
+			#endif
+			#ifdef TIM10
+				case 10: return TIM10;
+			#endif
+			#ifdef TIM11
+				case 11: return TIM11;
+			#endif
+			#ifdef TIM12
+				case 12: return TIM12;
+			#endif
+			#ifdef TIM13
+				case 13: return TIM13;
+			#endif
+			#ifdef TIM14
+				case 14: return TIM14;
+			#endif
+			#ifdef TIM15
+				case 15: return TIM15;
+			#endif
+			#ifdef TIM16
+				case 16: return TIM16;
+			#endif
+			#ifdef TIM17
+				case 17: return TIM17;
+			#endif
+			}
+			return TIM3;
+		}
+
+		/**
+		 * \brief Select hardware timer, TIM1 to TIM17, and create its HardwareTimer
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+		 */
+		void uTimerLib::_setTimer(unsigned char timer) {
+			_timer = timer;
+			_hwTimer = new HardwareTimer(_stm32Tim(timer));
+			_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+		}
+
+		/**
+		 * \brief Timer has 32 bit counter, as TIM2 and TIM5 on most families
+		 */
+		static bool _stm32Wide(unsigned char timer) {
+			#ifdef IS_TIM_32B_COUNTER_INSTANCE
+				return IS_TIM_32B_COUNTER_INSTANCE(_stm32Tim(timer));
+			#else
+				return false;
+			#endif
+		}
+
+	// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+	#else
+		#if (UTIMERLIB_TIMERS & ~0x1EUL)
+			#error "UTIMERLIB_TIMERS: STM32 timers are Timer1 to Timer4"
+		#endif
+
+		/**
+		 * \brief Select hardware timer, Timer1 to Timer4, and its interrupt handler
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	timer	Timer number; must be in UTIMERLIB_TIMERS
+		 */
+		void uTimerLib::_setTimer(unsigned char timer) {
+			static HardwareTimer * const timers[] = {&Timer1, &Timer2, &Timer3, &Timer4};
+			static void (* const handlers[])() = {interrupt<1>, interrupt<2>, interrupt<3>, interrupt<4>};
+			_timer = timer;
+			_hwTimer = timers[timer - 1];
+			_handler = handlers[timer - 1];
+			_instances[UTIMERLIB_TIMER_INDEX(timer)] = this;
+		}
+
+		/**
+		 * \brief Longest timer loop, in microseconds, as setPeriod counts them in 32 bit CPU cycles
+		 */
+		#define UTIMERLIB_STM32_LOOP_US (0xFFFFFFFFUL / (F_CPU / 1000000))
+	#endif
+
+	/**
+	 * \brief Timer clock cycles of us microseconds
+	 *
+	 * @param	us			Time in microseconds
+	 * @param	hz			Timer input clock, in Hz
+	 * @return	Clock cycles, truncated
+	 */
+	static inline unsigned long long _stm32Cycles(unsigned long long us, unsigned long int hz) {
+		return us * (hz / 1000000) + us * (hz % 1000000) / 1000000;
+	}
+
+	/**
+	 * \brief Splits cycles in equal timer loops, each one with smallest prescaler that fits, so resolution is finest
+	 *
+	 * A 32 bit timer fits any 32 bit time in one loop, and 16 bit ones up to 2^32 clock cycles (59s at 72MHz).
+	 *
+	 * @param	cycles		Time in timer clock cycles
+	 * @param	wide		Timer has 32 bit counter
+	 * @param	prescaler	Returns prescaler factor, 1 to 65536
+	 * @param	ticks		Returns counts of each loop
+	 * @return	Number of loops
+	 */
+	static unsigned long int _stm32Fit(unsigned long long cycles, bool wide, unsigned long int & prescaler, unsigned long int & ticks) {
+		unsigned long long top = wide ? 0xFFFFFFFFULL : 0x10000ULL;
+		unsigned long long loops = (cycles + (top << 16) - 1) / (top << 16);
+		if (loops == 0) {
+			loops = 1;
+		}
+		cycles = (cycles + loops / 2) / loops;
+		prescaler = (cycles + top - 1) / top;
+		if (prescaler == 0) {
+			prescaler = 1;
+		}
+		ticks = (cycles + prescaler / 2) / prescaler;
+		if (ticks == 0) {
+			ticks = 1;
+		}
+		return loops;
+	}
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for desired ms microseconds
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_us(unsigned long int us) {
+		_attachInterrupt_long(us);
+	}
+
+
+	/**
+	 * \brief Sets up the timer, calculation variables and interrupts for any us microseconds time
+	 *
+	 * Prescaler and reload are fitted to the time, so it is one interrupt per period while it fits in one timer loop:
+	 * any 32 bit time on 32 bit timers (TIM2, TIM5) and up to 2^32 clock cycles on 16 bit ones. Longer ones are split in equal loops.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	us		Desired timing in microseconds
+	 */
+	void uTimerLib::_attachInterrupt_long(unsigned long long us) {
+		if (us == 0) { // Not valid
+			return;
+		}
+
+		// Tick format on ST's core, as microseconds one overflows over 2^32 clock cycles and only uses 16 bit reloads
+		unsigned long int prescaler, ticks;
+		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+		#ifdef BOARD_NAME
+			unsigned long int loops = _stm32Fit(_stm32Cycles(us, _hwTimer->getTimerClkFreq()), _stm32Wide(_timer), prescaler, ticks);
+
+		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+		#else
+			unsigned long int loops = _stm32Fit(_stm32Cycles(us, F_CPU), false, prescaler, ticks);
+		#endif
+		_fracNum = 0;
+		_attachInterrupt_raw(loops, prescaler, ticks);
+	}
+
+
+	/**
+	 * \brief Starts timer with loops equal loops of ticks counts, at timer clock divided by prescaler
+	 *
+	 * Interrupt is update one, on counter wrap, so each loop ends exactly on its last count and count read at ISR entry is
+	 * its latency. Timer is paused while it is set up, so update event loading prescaler does not call it.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	loops		Number of loops of each period
+	 * @param	prescaler	Prescaler factor, 1 to 65536
+	 * @param	ticks		Counts of each loop
+	 */
+	void uTimerLib::_attachInterrupt_raw(unsigned long int loops, unsigned long int prescaler, unsigned long int ticks) {
+		__overflows = _overflows = loops > 1 ? loops : 0;
+		__remaining = _remaining = 0;
+		_ticks = ticks;
+		_hwTimer->pause();
+		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+		#ifdef BOARD_NAME
+			_hwTimer->setPrescaleFactor(prescaler);
+			_hwTimer->setOverflow(ticks, TICK_FORMAT);
+			if (_toInit) {
+				_toInit = false;
+				_hwTimer->attachInterrupt([this]() { _interrupt(); });
+			}
+			_hwTimer->refresh(); // Update event: loads preloaded prescaler and reload now, and restarts count
+			_hwTimer->resume(); // Clears update flag before enabling its interrupt
+
+		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+		#else
+			_hwTimer->setPrescaleFactor(prescaler);
+			_hwTimer->setOverflow(ticks - 1);
+			if (_toInit) {
+				_toInit = false;
+				_hwTimer->attachInterrupt(TIMER_UPDATE_INTERRUPT, _handler);
+			}
+			_hwTimer->refresh(); // Update event: loads preloaded prescaler and reload now, and restarts count
+			_hwTimer->c_dev()->regs.bas->SR = ~TIMER_SR_UIF; // Its update flag is not an end of period
+			_hwTimer->resume();
+		#endif
+	}
+
+
+	#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+		/**
+		 * \brief Sets up the timer for a period of hz frequency, with prescaler and counts fitted to timer clock / hz
+		 *
+		 * Fraction of a count left is kept, so _interrupt makes some periods one count longer.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	hz		Frequency in Hz
+		 * @return	Achieved frequency in mHz
+		 */
+		unsigned long int uTimerLib::_attachFrequency(unsigned long int hz) {
+			// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+			#ifdef BOARD_NAME
+				unsigned long int clk = _hwTimer->getTimerClkFreq();
+				bool wide = _stm32Wide(_timer);
+			// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+			#else
+				unsigned long int clk = F_CPU;
+				bool wide = false;
+			#endif
+			unsigned long int prescaler, ticks;
+			// Always one loop, as any hz fits in 2^32 cycles, and one cycle more so a count can be added; hz * prescaler fits in 32 bits
+			unsigned long int loops = _stm32Fit(clk / hz + 1, wide, prescaler, ticks);
+			_fracDen = hz * prescaler;
+			ticks = clk / _fracDen;
+			_fracNum = ticks > 0 ? clk % _fracDen : 0;
+			_fracErr = _fracDen / 2;
+			if (ticks == 0) {
+				ticks = 1;
+			}
+			_attachInterrupt_raw(loops, prescaler, ticks);
+			return _milliHz(clk, 0, (unsigned long long) prescaler * ticks, _fracNum, hz); // Fraction, in cycles, is _fracNum / hz
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_HW_WAVE // ST's core only
+		/**
+		 * \brief Starts a square wave of us microseconds period on pin, toggled by timer channel on each compare match, without interrupt
+		 *
+		 * Pin must be a TIMx_CHy output of timer (not a complementary CHyN one) and half period must fit in one timer loop.
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	pin		Arduino pin number
+		 * @param	us		Square wave period in microseconds
+		 * @return	false if pin is not timer output or half period does not fit
+		 */
+		bool uTimerLib::_attachSquareWave(unsigned char pin, unsigned long int us) {
+			PinName name = digitalPinToPinName(pin);
+			if ((TIM_TypeDef *) pinmap_peripheral(name, PinMap_TIM) != _stm32Tim(_timer)) {
+				return false;
+			}
+			unsigned long int function = pinmap_function(name, PinMap_TIM);
+			unsigned long int prescaler, ticks;
+			// Half period ticks, at half clock
+			if (STM_PIN_INVERTED(function) || _stm32Fit(_stm32Cycles(us, _hwTimer->getTimerClkFreq() / 2), _stm32Wide(_timer), prescaler, ticks) > 1) {
+				return false;
+			}
+			if (!_toInit) { // Update interrupt is not used, it is attached again by next setXXX
+				_toInit = true;
+				_hwTimer->detachInterrupt();
+			}
+			_waveChannel = STM_PIN_CHANNEL(function);
+			__overflows = _overflows = 0;
+			__remaining = _remaining = 0;
+			_hwTimer->setMode(_waveChannel, TIMER_OUTPUT_COMPARE_TOGGLE, name);
+			_hwTimer->setPrescaleFactor(prescaler);
+			_hwTimer->setOverflow(ticks, TICK_FORMAT);
+			_hwTimer->setCaptureCompare(_waveChannel, 0, TICK_COMPARE_FORMAT);
+			_hwTimer->refresh();
+			_hwTimer->resume();
+			return true;
+		}
+	#endif
+
+
+	#ifdef UTIMERLIB_RELOAD
+		/**
+		 * \brief Publishes a new period for changePeriod_us, loaded by _interrupt on next period boundary
+		 *
+		 * Note: This is device-dependant
+		 *
+		 * @param	us		New period in microseconds
+		 * @return	false if running or new period does not fit in one timer loop
+		 */
+		bool uTimerLib::_changePeriod_us(unsigned long int us) {
+			if (__overflows > 0) {
+				return false;
+			}
+			// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+			#ifdef BOARD_NAME
+				unsigned long int prescaler, ticks;
+				if (_stm32Fit(_stm32Cycles(us, _hwTimer->getTimerClkFreq()), _stm32Wide(_timer), prescaler, ticks) > 1) {
+					return false;
+				}
+				_setNext(0, ticks, 0, 0, 1, prescaler);
+
+			// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+			#else
+				if (us > UTIMERLIB_STM32_LOOP_US) {
+					return false;
+				}
+				_setNext(0, us, 0, 0, 1, 0);
+			#endif
+			return true;
+		}
+
+
+		/**
+		 * \brief Loads period published by changePeriod_us on timer
+		 *
+		 * Prescaler and ARR are preloaded by hardware on ST's core, so there new values are used from next update event.
+		 *
+		 * Note: This is device-dependant
+		 */
+		void uTimerLib::_loadNext() {
+			_takeNext();
+			// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+			#ifdef BOARD_NAME
+				_hwTimer->setPrescaleFactor(_nextPrescaler);
+				_hwTimer->setOverflow(__remaining, TICK_FORMAT);
+
+			// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+			#else
+				_hwTimer->setPeriod(__remaining);
+			#endif
+			__remaining = 0;
+		}
+	#endif
+
+
+	/**
+	 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::_loadRemaining() { }
+
+	/**
+	 * \brief Clear timer interrupts
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::clearTimer() {
+		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+		#ifdef BOARD_NAME
+			_hwTimer->pause();
+			if (_type == UTIMERLIB_TYPE_WAVE) { // Channel would toggle pin again when timer is resumed
+				_hwTimer->setMode(_waveChannel, TIMER_DISABLED);
+			}
+			_type = UTIMERLIB_TYPE_OFF;
+
+		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+		#else
+			_type = UTIMERLIB_TYPE_OFF;
+			_hwTimer->pause();
+		#endif
+	}
+
+	/**
+	 * \brief Sleeps until next timed function call
+	 *
+	 * Timer needs peripheral clocks, so only CPU is stopped (sleep mode, WFI). Any other interrupt wakes up CPU, and it sleeps again.
+	 *
+	 * Note: This is device-dependant
+	 */
+	void uTimerLib::sleepUntilNext() {
+		unsigned char calls = _calls;
+		for (;;) {
+			noInterrupts();
+			if (_calls != calls || _type == UTIMERLIB_TYPE_OFF || _type == UTIMERLIB_TYPE_WAVE) { // Square wave has no calls
+				interrupts();
+				return;
+			}
+			// WFI wakes up on pending interrupt even when they are disabled, so none is lost between check and sleep
+			__asm__ volatile ("dsb\n\twfi");
+			interrupts();
+		}
+	}
+
+	/**
+	 * \brief Reads position in current period, for now_ticks() and remaining_us()
+	 *
+	 * Periods longer than one timer loop are counted in equal loops by _interrupt.
+	 *
+	 * Note: This is device-dependant
+	 *
+	 * @param	elapsed		Returns timer counts since period started
+	 * @param	total		Returns timer counts of whole period
+	 * @param	hz			Returns timer counts per second
+	 * @return	false if timer is not running
+	 */
+	bool uTimerLib::_readPeriod(unsigned long long & elapsed, unsigned long long & total, unsigned long int & hz) {
+		UTIMERLIB_LOCK();
+		if (_type == UTIMERLIB_TYPE_OFF) {
+			UTIMERLIB_UNLOCK();
+			return false;
+		}
+		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+		#ifdef BOARD_NAME
+			unsigned long int count = _hwTimer->getCount();
+			unsigned long int loop = _hwTimer->getOverflow();
+			hz = _hwTimer->getTimerClkFreq() / _hwTimer->getPrescaleFactor();
+
+		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+		#else
+			unsigned long int count = _hwTimer->getCount();
+			unsigned long int loop = (unsigned long int) _hwTimer->getOverflow() + 1;
+			hz = F_CPU / _hwTimer->getPrescaleFactor();
+		#endif
+		if (__overflows > 0) {
+			elapsed = (unsigned long long) (__overflows - _overflows) * loop + count;
+			total = (unsigned long long) __overflows * loop;
+		} else {
+			elapsed = count;
+			total = loop;
+		}
+		UTIMERLIB_UNLOCK();
+		return true;
+	}
+
+	/**
+	 * \brief Internal intermediate function to control timer interrupts
+	 *
+	 * As timers doesn't give us enougth flexibility for large timings,
+	 * this function implements oferflow control to offer user desired timings.
+	 */
+	void uTimerLib::_interrupt() {
+		UTIMERLIB_TRACE_ISR();
+		#ifdef UTIMERLIB_STATS
+			_statsIsr(_statsLatency());
+		#endif
+		if (_type == UTIMERLIB_TYPE_OFF) { // Should not happen
+			return;
+		}
+		// Long periods are X equal loops (none when period fits in one). So wee compare upper than 1
+		if (_overflows > 1) {
+			UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_OVERFLOW);
+			_overflows--;
+		} else {
+			#ifdef UTIMERLIB_RELOAD
+				if (_nextReady && _type == UTIMERLIB_TYPE_INTERVAL) {
+					_loadNext();
+				}
+			#endif
+			if (_fracNum != 0) { // Reload is preloaded, so it is next period that can be one count longer
+				#ifdef BOARD_NAME
+					_hwTimer->setOverflow(_ticks + _fracStep(), TICK_FORMAT);
+				#else
+					_hwTimer->setOverflow(_ticks - 1 + _fracStep());
+				#endif
+			}
+			_overflows = __overflows;
+			if (_type == UTIMERLIB_TYPE_TIMEOUT) {
+				clearTimer();
+			}
+			_callback();
+		}
+	}
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer count, in timer clock cycles. Interrupt is update one, when count restarts, so at ISR entry it is entry latency
+		 *
+		 * Note: This is device-dependant
+		 */
+		unsigned long int uTimerLib::_statsLatency() {
+			#ifdef BOARD_NAME
+				return _hwTimer->getCount() * _hwTimer->getPrescaleFactor();
+			#else
+				return (unsigned long int) _hwTimer->getCount() * _hwTimer->getPrescaleFactor();
+			#endif
+		}
+
+		#ifdef UTIMERLIB_DWT_CYCCNT
+			/**
+			 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+			 *
+			 * Note: This is device-dependant
+			 */
+			unsigned long int uTimerLib::_statsCycles() {
+				return UTIMERLIB_DWT_CYCCNT;
+			}
+
+			/**
+			 * \brief CPU cycles since a _statsCycles time stamp
+			 *
+			 * Note: This is device-dependant
+			 *
+			 * @param	start	Time stamp
+			 * @return	Elapsed CPU cycles
+			 */
+			unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+				return UTIMERLIB_DWT_CYCCNT - start;
+			}
+		#else
+			/**
+			 * \brief Time stamp, in CPU cycles, to measure callbacks with _statsElapsed
+			 *
+			 * Cortex-M0 / M0+ has no DWT cycle counter, so SysTick, running at CPU clock and reloaded each ms by core, is used.
+			 *
+			 * Note: This is device-dependant
+			 */
+			unsigned long int uTimerLib::_statsCycles() {
+				return SysTick->LOAD - SysTick->VAL;
+			}
+
+			/**
+			 * \brief CPU cycles since a _statsCycles time stamp, up to two SysTick reloads (2ms)
+			 *
+			 * Note: This is device-dependant
+			 *
+			 * @param	start	Time stamp
+			 * @return	Elapsed CPU cycles
+			 */
+			unsigned long int uTimerLib::_statsElapsed(unsigned long int start) {
+				unsigned long int now = _statsCycles();
+				if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) { // Reloaded while measuring; read again, as it may reload just after first read
+					now = _statsCycles() + SysTick->LOAD + 1;
+				}
+				return now > start ? now - start : 0;
+			}
+		#endif
+	#endif
+
+
+	/**
+	 * \brief Preinstantiate Object
+	 *
+	 * Now you can use al functionality calling Timerlib.function
+	 */
+	uTimerLib TimerLib = uTimerLib();
+
+#endif
+#endif
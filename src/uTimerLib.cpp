@@ -1,142 +1,1871 @@
-/**
- * \class uTimerLib
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @file uTimerLib.cpp
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-
-// # if !defined(_uTimerLib_cpp_) && defined(_uTimerLib_IMP_)
-#ifndef _uTimerLib_cpp_
-    #define _uTimerLib_cpp_
-    #include "uTimerLib.h"
-
-    // extern uTimerLib TimerLib;
-
-    #if defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)
-            uTimerLib *uTimerLib::_instance = NULL;
-    #endif
-
-    /**
-     * \brief Constructor
-     */
-    uTimerLib::uTimerLib() {
-            #ifdef _VARIANT_ARDUINO_STM32_
-                    _instance = this;
-                    clearTimer();
-            #endif
-    }
-
-    /**
-     * \brief Attaches a callback function to be executed each us microseconds
-     *
-     * @param	cb		Callback function to be called
-     * @param	us		Interval in microseconds
-     */
-    void uTimerLib::setInterval_us(void (* cb)(), unsigned long int us) {
-            clearTimer();
-            _cb = cb;
-            _type = UTIMERLIB_TYPE_INTERVAL;
-            _attachInterrupt_us(us);
-    }
-
-
-    /**
-     * \brief Attaches a callback function to be executed once when us microseconds have passed
-     *
-     * @param	cb		Callback function to be called
-     * @param	us		Timeout in microseconds
-     */
-    void uTimerLib::setTimeout_us(void (* cb)(), unsigned long int us) {
-            clearTimer();
-            _cb = cb;
-            _type = UTIMERLIB_TYPE_TIMEOUT;
-            _attachInterrupt_us(us);
-    }
-
-
-    /**
-     * \brief Attaches a callback function to be executed each s seconds
-     *
-     * @param	cb		Callback function to be called
-     * @param	s		Interval in seconds
-     */
-    void uTimerLib::setInterval_s(void (* cb)(), unsigned long int s) {
-            clearTimer();
-            _cb = cb;
-            _type = UTIMERLIB_TYPE_INTERVAL;
-            _attachInterrupt_s(s);
-    }
-
-
-    /**
-     * \brief Attaches a callback function to be executed once when s seconds have passed
-     *
-     * @param	cb		Callback function to be called
-     * @param	s		Timeout in seconds
-     */
-    void uTimerLib::setTimeout_s(void (* cb)(), unsigned long int s) {
-            clearTimer();
-            _cb = cb;
-            _type = UTIMERLIB_TYPE_TIMEOUT;
-            _attachInterrupt_s(s);
-    }
-
-    #define UTIMERLIB_HW_COMPILE
-
-    // Now load each hardware variation support:
-
-    #if (defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_AVR)) && !defined(ARDUINO_attiny) && !defined(ARDUINO_AVR_ATTINYX4) && !defined(ARDUINO_AVR_ATTINYX5) && !defined(ARDUINO_AVR_ATTINYX7) && !defined(ARDUINO_AVR_ATTINYX8) && !defined(ARDUINO_AVR_ATTINYX61) && !defined(ARDUINO_AVR_ATTINY43) && !defined(ARDUINO_AVR_ATTINY828) && !defined(ARDUINO_AVR_ATTINY1634) && !defined(ARDUINO_AVR_ATTINYX313)
-            #include "hardware/uTimerLib.AVR.cpp"
-    #endif
-
-    #if defined(ARDUINO_ARCH_AVR) && (defined(ARDUINO_attiny) ||defined(ARDUINO_AVR_ATTINYX5))
-            #include "hardware/uTimerLib.ATTINY.cpp"
-    #endif
-
-    #if defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)
-        #include "hardware/uTimerLib.STM32.cpp"
-    #endif
-
-    #if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
-            #include "hardware/uTimerLib.ESP.cpp"
-    #endif
-    #ifdef ARDUINO_ARCH_SAM
-            #include "hardware/uTimerLib.SAM.cpp"
-    #endif
-    #ifdef _SAMD21_
-            #include "hardware/uTimerLib.SAMD21.cpp"
-    #endif
-    #ifdef __SAMD51__
-            #include "hardware/uTimerLib.SAMD51.cpp"
-    #endif
-
-
-    #if !defined(__AVR_ATmega32U4__) && !defined(ARDUINO_ARCH_AVR) && !defined(_VARIANT_ARDUINO_STM32_) && !defined(ARDUINO_ARCH_STM32) && !defined(ARDUINO_ARCH_ESP8266) && !defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_ARCH_SAM) && !defined(_SAMD21_) && !defined(__SAMD51__) && !defined(ARDUINO_attiny) && !defined(ARDUINO_AVR_ATTINYX5)
-        #include "hardware/uTimerLib.UNSUPPORTED.cpp"
-    #endif
-
-#endif
+/**
+ * \class uTimerLib
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * @file uTimerLib.cpp
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+
+// # if !defined(_uTimerLib_cpp_) && defined(_uTimerLib_IMP_)
+#ifndef _uTimerLib_cpp_
+    #define _uTimerLib_cpp_
+    #include "uTimerLib.h"
+
+    // extern uTimerLib TimerLib;
+
+    // Configuration this file is built with; files including uTimerLib.h with other UTIMERLIB_XXX macros will not link
+    template <> const char uTimerLibThisConfig::check = 0;
+
+    #ifdef UTIMERLIB_HW_TIMERS
+            uTimerLib * uTimerLib::_instances[__builtin_popcountl(UTIMERLIB_TIMERS)] = {};
+    #endif
+
+    // Short critical section, restoring previous interrupt state so it can be used from callbacks too
+    #if defined(ARDUINO_ARCH_AVR)
+            #define UTIMERLIB_LOCK() unsigned char _utimerlib_sreg = SREG; cli()
+            #define UTIMERLIB_UNLOCK() SREG = _utimerlib_sreg
+    #elif defined(ARDUINO_ARCH_SAM) || defined(_SAMD21_) || defined(__SAMD51__) || defined(ARDUINO_ARCH_STM32)
+            #define UTIMERLIB_LOCK() uint32_t _utimerlib_primask = __get_PRIMASK(); __disable_irq()
+            #define UTIMERLIB_UNLOCK() __set_PRIMASK(_utimerlib_primask)
+    #elif defined(ARDUINO_ARCH_ESP8266)
+            #define UTIMERLIB_LOCK() uint32_t _utimerlib_ps = xt_rsil(15)
+            #define UTIMERLIB_UNLOCK() xt_wsr_ps(_utimerlib_ps)
+    #elif defined(ARDUINO_ARCH_ESP32)
+            // Spinlock, as timer interrupt can run on the other core; usable from tasks and interrupts, and nestable on same core
+            static portMUX_TYPE _utimerlib_mux = portMUX_INITIALIZER_UNLOCKED;
+            #define UTIMERLIB_LOCK() portENTER_CRITICAL_SAFE(&_utimerlib_mux)
+            #define UTIMERLIB_UNLOCK() portEXIT_CRITICAL_SAFE(&_utimerlib_mux)
+    #else
+            #define UTIMERLIB_LOCK() noInterrupts()
+            #define UTIMERLIB_UNLOCK() interrupts()
+    #endif
+
+    // Timer interrupt side of lock, around state shared with setXXX / clearTimer / getXXX. Only ESP32 needs it, as there they can
+    // run on the other core at same time; on other devices they are already stopped while timer interrupt runs
+    #ifdef ARDUINO_ARCH_ESP32
+            #define UTIMERLIB_ISR_LOCK() UTIMERLIB_LOCK()
+            #define UTIMERLIB_ISR_UNLOCK() UTIMERLIB_UNLOCK()
+    #else
+            #define UTIMERLIB_ISR_LOCK()
+            #define UTIMERLIB_ISR_UNLOCK()
+    #endif
+
+    #ifdef UTIMERLIB_TRACE
+            uTimerLibTraceEvent uTimerLib::_trace[UTIMERLIB_TRACE_SIZE] = {};
+            volatile unsigned long int uTimerLib::_traceCount = 0;
+
+            #define UTIMERLIB_TRACE_EVENT(kind) _traceEvent(kind)
+
+            /**
+             * \brief Logs a trace event of this object in ring buffer, overwriting oldest one when full
+             *
+             * @param	kind	One of UTIMERLIB_TRACE_xxx
+             */
+            inline void UTIMERLIB_ISR_ATTR uTimerLib::_traceEvent(unsigned char kind) {
+                    UTIMERLIB_LOCK();
+                    uTimerLibTraceEvent & event = _trace[_traceCount & (UTIMERLIB_TRACE_SIZE - 1)];
+                    event.us = micros();
+                    #ifdef UTIMERLIB_HW_TIMERS
+                            event.timer = _timer;
+                    #else
+                            event.timer = 0;
+                    #endif
+                    event.kind = kind;
+                    _traceCount = _traceCount + 1;
+                    UTIMERLIB_UNLOCK();
+            }
+
+
+            /**
+             * \brief Prints logged trace events, oldest first, as "micros timer event" lines
+             *
+             * Call it out of interrupt context: each event is copied with interrupts disabled and printed with them enabled, and
+             * events logged meanwhile are kept for next call, as buffer is not cleared.
+             *
+             * @param	out		Where to print, as Serial
+             */
+            void uTimerLib::dumpTrace(Stream & out) {
+                    static const char * const kinds[] = {"?", "overflow", "remaining", "fire", "overrun"};
+                    UTIMERLIB_LOCK();
+                    unsigned long int end = _traceCount;
+                    UTIMERLIB_UNLOCK();
+                    unsigned long int n = end - (end > UTIMERLIB_TRACE_SIZE ? UTIMERLIB_TRACE_SIZE : end);
+                    out.print("uTimerLib trace: ");
+                    out.print(end);
+                    out.println(" events");
+                    for (; n != end; n++) {
+                            UTIMERLIB_LOCK();
+                            bool lost = _traceCount - n > UTIMERLIB_TRACE_SIZE; // Overwritten while printing
+                            uTimerLibTraceEvent event = _trace[n & (UTIMERLIB_TRACE_SIZE - 1)];
+                            UTIMERLIB_UNLOCK();
+                            if (lost) {
+                                    continue;
+                            }
+                            out.print(event.us);
+                            out.print(' ');
+                            out.print(event.timer);
+                            out.print(' ');
+                            out.println(kinds[event.kind <= UTIMERLIB_TRACE_OVERRUN ? event.kind : 0]);
+                    }
+            }
+    #else
+            #define UTIMERLIB_TRACE_EVENT(kind)
+    #endif
+
+    #ifdef UTIMERLIB_TRACE_PIN
+            /**
+             * \brief Drives UTIMERLIB_TRACE_PIN high while in scope, so each timer interrupt is seen on a scope or logic analyzer
+             *
+             * Always inlined into interrupt, as constructors cannot be placed on a section (UTIMERLIB_ISR_ATTR) of their own.
+             */
+            struct _uTimerLibTracePin {
+                    inline __attribute__((always_inline)) _uTimerLibTracePin() {
+                            digitalWrite(UTIMERLIB_TRACE_PIN, HIGH);
+                    }
+                    inline __attribute__((always_inline)) ~_uTimerLibTracePin() {
+                            digitalWrite(UTIMERLIB_TRACE_PIN, LOW);
+                    }
+            };
+
+            #define UTIMERLIB_TRACE_ISR() _uTimerLibTracePin _utimerlib_trace_pin
+    #else
+            #define UTIMERLIB_TRACE_ISR()
+    #endif
+
+    /**
+     * \brief Constructor
+     *
+     * @param	timer	Hardware timer number, one of UTIMERLIB_TIMERS (see UTIMERLIB_TIMER); ignored on ATtiny and ESP8266
+     */
+    uTimerLib::uTimerLib(unsigned char timer) {
+            #ifdef UTIMERLIB_HW_TIMERS
+                    _setTimer(timer);
+            #endif
+            #ifdef UTIMERLIB_TRACE_PIN
+                    pinMode(UTIMERLIB_TRACE_PIN, OUTPUT);
+            #endif
+            #ifdef _VARIANT_ARDUINO_STM32_
+                    clearTimer();
+            #endif
+    }
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed each us microseconds
+             *
+             * @param	cb		Callback function to be called
+             * @param	us		Interval in microseconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setInterval_us(uTimerLibDelegate cb, unsigned long int us) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_INTERVAL, _usToTicks(us));
+                    #else
+                            if (us == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_INTERVAL;
+                            _periodSetup(us);
+                            _attachInterrupt_us(us);
+                            return _newHandle(us);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_INTERVAL_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed once when us microseconds have passed
+             *
+             * @param	cb		Callback function to be called
+             * @param	us		Timeout in microseconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setTimeout_us(uTimerLibDelegate cb, unsigned long int us) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_TIMEOUT, _usToTicks(us));
+                    #else
+                            if (us == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_TIMEOUT;
+                            _periodSetup(us);
+                            _attachInterrupt_us(us);
+                            return _newHandle(us);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_US_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed each s seconds
+             *
+             * @param	cb		Callback function to be called
+             * @param	s		Interval in seconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setInterval_s(uTimerLibDelegate cb, unsigned long int s) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_INTERVAL, s * (1000000ULL / UTIMERLIB_TICK_US));
+                    #else
+                            if (s == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_INTERVAL;
+                            _periodSetup(s * 1000000ULL);
+                            _attachInterrupt_long(s * 1000000ULL);
+                            return _newHandle(s);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_INTERVAL_ONLY) && !defined(UTIMERLIB_US_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed once when s seconds have passed
+             *
+             * @param	cb		Callback function to be called
+             * @param	s		Timeout in seconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setTimeout_s(uTimerLibDelegate cb, unsigned long int s) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_TIMEOUT, s * (1000000ULL / UTIMERLIB_TICK_US));
+                    #else
+                            if (s == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_TIMEOUT;
+                            _periodSetup(s * 1000000ULL);
+                            _attachInterrupt_long(s * 1000000ULL);
+                            return _newHandle(s);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed each ms milliseconds
+             *
+             * @param	cb		Callback function to be called
+             * @param	ms		Interval in milliseconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setInterval_ms(uTimerLibDelegate cb, unsigned long int ms) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_INTERVAL, _usToTicks(ms * 1000ULL));
+                    #else
+                            if (ms == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_INTERVAL;
+                            _periodSetup(ms * 1000ULL);
+                            _attachInterrupt_us64(ms * 1000ULL);
+                            return _newHandle(ms);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_INTERVAL_ONLY) && !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed once when ms milliseconds have passed
+             *
+             * @param	cb		Callback function to be called
+             * @param	ms		Timeout in milliseconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setTimeout_ms(uTimerLibDelegate cb, unsigned long int ms) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_TIMEOUT, _usToTicks(ms * 1000ULL));
+                    #else
+                            if (ms == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_TIMEOUT;
+                            _periodSetup(ms * 1000ULL);
+                            _attachInterrupt_us64(ms * 1000ULL);
+                            return _newHandle(ms);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed each ticks UTIMERLIB_TICK_US ticks
+             *
+             * @param	cb		Callback function to be called
+             * @param	ticks		Interval in UTIMERLIB_TICK_US ticks, limited to 0x7FFFFFFF when UTIMERLIB_SLOTS > 1
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setInterval_ticks(uTimerLibDelegate cb, unsigned long long ticks) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_INTERVAL, ticks);
+                    #else
+                            if (ticks == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_INTERVAL;
+                            _periodSetup(ticks * UTIMERLIB_TICK_US);
+                            _attachInterrupt_us64(ticks * UTIMERLIB_TICK_US);
+                            return _newHandle(1);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_INTERVAL_ONLY) && !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Attaches a callback function to be executed once when ticks UTIMERLIB_TICK_US ticks have passed
+             *
+             * @param	cb		Callback function to be called
+             * @param	ticks		Timeout in UTIMERLIB_TICK_US ticks, limited to 0x7FFFFFFF when UTIMERLIB_SLOTS > 1
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setTimeout_ticks(uTimerLibDelegate cb, unsigned long long ticks) {
+                    #if UTIMERLIB_SLOTS > 1
+                            return _addSlot(cb, UTIMERLIB_TYPE_TIMEOUT, ticks);
+                    #else
+                            if (ticks == 0) { // Not valid; running timed function is kept, as with UTIMERLIB_SLOTS > 1
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_TIMEOUT;
+                            _periodSetup(ticks * UTIMERLIB_TICK_US);
+                            _attachInterrupt_us64(ticks * UTIMERLIB_TICK_US);
+                            return _newHandle(1);
+                    #endif
+            }
+    #endif
+
+
+    /**
+     * \brief Cancels one timed function, given its handle
+     *
+     * Handles of already finished or cancelled timed functions are ignored.
+     *
+     * @param	handle		Handle returned by setXXX method
+     */
+    void uTimerLib::clearTimer(uTimerLibHandle handle) {
+            #if UTIMERLIB_SLOTS > 1
+                    unsigned char slot = (handle & 0xFF) - 1;
+                    if (slot < UTIMERLIB_SLOTS && _slots[slot].gen == (handle >> 8)) {
+                            _slots[slot].type = UTIMERLIB_TYPE_OFF;
+                    }
+            #else
+                    if (handle != UTIMERLIB_INVALID_HANDLE && handle == (((uTimerLibHandle) _gen << 8) | 1) && _type != UTIMERLIB_TYPE_OFF) {
+                            clearTimer();
+                    }
+            #endif
+    }
+
+
+    #ifndef UTIMERLIB_TIMEOUT_ONLY
+            /**
+             * \brief Changes period of a running interval, from next period on, without stopping timer nor disabling interrupts
+             *
+             * New period is published to timer interrupt, that loads it when current period ends. It can be called from timed function
+             * itself: period that has just started keeps old time, next one uses new time. On SAMD21 / SAMD51 running prescaler is kept,
+             * as it cannot be changed without disabling timer, so resolution is that of the old period.
+             * Only one context should change same timed function at a time.
+             *
+             * @param	handle		Handle returned by setInterval_xxx method
+             * @param	us			New period in microseconds
+             * @return	false if handle is not a running interval or new period cannot be used (low power clock on AVR Timer2)
+             */
+            bool UTIMERLIB_ISR_ATTR uTimerLib::changePeriod_us(uTimerLibHandle handle, unsigned long int us) {
+                    #if UTIMERLIB_SLOTS > 1
+                            unsigned char slot = (handle & 0xFF) - 1;
+                            unsigned long long ticks = _usToTicks(us);
+                            if (ticks == 0 || ticks > 0x7FFFFFFFULL || slot >= UTIMERLIB_SLOTS || _slots[slot].gen != (handle >> 8) || _slots[slot].type != UTIMERLIB_TYPE_INTERVAL) {
+                                    return false;
+                            }
+                            // Tick reads next only when nextReady is set, so it never sees a half written value
+                            _slots[slot].nextReady = false;
+                            _slots[slot].next = ticks;
+                            _slots[slot].nextReady = true;
+                            return true;
+                    #else
+                            if (us == 0 || handle == UTIMERLIB_INVALID_HANDLE || handle != (((uTimerLibHandle) _gen << 8) | 1) || _type != UTIMERLIB_TYPE_INTERVAL) {
+                                    return false;
+                            }
+                            _periodSetup(us);
+                            return _changePeriod_us(us);
+                    #endif
+            }
+    #endif
+
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY)
+            /**
+             * \brief Timed function of setSquareWave_us when timer cannot toggle pin by itself
+             *
+             * @param	pin		Arduino pin number, stored as context
+             */
+            static void UTIMERLIB_ISR_ATTR _togglePin(void * pin) {
+                    unsigned char p = (unsigned char) (uintptr_t) pin;
+                    digitalWrite(p, digitalRead(p) == HIGH ? LOW : HIGH);
+            }
+
+
+            /**
+             * \brief Generates a square wave of us microseconds period on pin, toggling it each us / 2 microseconds
+             *
+             * When pin is an output of hardware timer (OCnA on AVR, OC1A on ATtiny, TIMx_CHy on ST's STM32 core) and half period
+             * fits in one timer loop, timer toggles it on compare match and no interrupt is used. Otherwise, and with
+             * UTIMERLIB_SLOTS > 1, a timed function toggles it, as setInterval_us(toggle, us / 2) would.
+             *
+             * @param	pin		Arduino pin number
+             * @param	us		Square wave period in microseconds
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setSquareWave_us(unsigned char pin, unsigned long int us) {
+                    if (us < 2) { // Not valid
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    pinMode(pin, OUTPUT);
+                    #ifdef UTIMERLIB_HW_WAVE
+                            clearTimer();
+                            if (_attachSquareWave(pin, us)) {
+                                    _cb = uTimerLibDelegate();
+                                    _type = UTIMERLIB_TYPE_WAVE;
+                                    return _newHandle(us);
+                            }
+                    #endif
+                    return setInterval_us(uTimerLibDelegate(_togglePin, (void *) (uintptr_t) pin), us / 2);
+            }
+
+
+            /**
+             * \brief Calls cb hz times per second, fitting timer counts to clock / hz, and reports achieved frequency
+             *
+             * Each device fits prescaler and top to timer clock / hz, as _attachInterrupt_us does for times: smallest prescaler that
+             * fits one loop, so resolution is finest with fewest interrupts, and fraction of a count is kept where device keeps one.
+             * Returned frequency is that of loaded counts and fraction, so it is hz unless counts are rounded (ESP8266 Timer1)
+             * or period is too short for device (1ms on ESP8266 OS timer).
+             * With UTIMERLIB_SLOTS > 1 period is whole UTIMERLIB_TICK_US ticks, whichever of floor and ceiling gives lowest error.
+             *
+             * @param	cb		Callback function to be called
+             * @param	hz		Frequency in Hz, up to 1000000
+             * @param	handle	Optional, returns handle of timed function
+             * @return	Achieved frequency in mHz, so caller can compensate; 0 if it cannot be scheduled
+             */
+            unsigned long int uTimerLib::setFrequency_hz(uTimerLibDelegate cb, unsigned long int hz, uTimerLibHandle * handle) {
+                    if (handle != NULL) {
+                            *handle = UTIMERLIB_INVALID_HANDLE;
+                    }
+                    if (hz == 0 || hz > 1000000) { // Not valid
+                            return 0;
+                    }
+                    #if UTIMERLIB_SLOTS > 1
+                            // Errors of floor and ceiling periods are r / p and (step - r) / (p + 1), in ticks
+                            unsigned long long step = (unsigned long long) hz * UTIMERLIB_TICK_US;
+                            unsigned long long p = 1000000ULL / step;
+                            unsigned long long r = 1000000ULL - p * step;
+                            if (p == 0 || (r > 0 && (step - r) * p < r * (p + 1))) {
+                                    p++;
+                            }
+                            unsigned long int us = (unsigned long int) (p * UTIMERLIB_TICK_US);
+                            uTimerLibHandle h = setInterval_us(cb, us);
+                            if (handle != NULL) {
+                                    *handle = h;
+                            }
+                            return h == UTIMERLIB_INVALID_HANDLE ? 0 : (unsigned long int) ((1000000000ULL + us / 2) / us);
+                    #else
+                            clearTimer();
+                            _cb = cb;
+                            _type = UTIMERLIB_TYPE_INTERVAL;
+                            unsigned long int us = (1000000 + hz / 2) / hz; // Nearest period, for statistics and overruns
+                            _periodSetup(us);
+                            unsigned long int achieved = _attachFrequency(hz);
+                            if (achieved == 0) {
+                                    clearTimer();
+                                    return 0;
+                            }
+                            uTimerLibHandle h = _newHandle(us);
+                            if (handle != NULL) {
+                                    *handle = h;
+                            }
+                            return achieved;
+                    #endif
+            }
+    #endif
+
+
+    #ifdef UTIMERLIB_GROUP
+            /**
+             * \brief Starts a group of timed functions sharing a period, each one called phases[i] microseconds after each period boundary
+             *
+             * One timed function calls them in phase order and publishes, as changePeriod_us does, the time to next distinct phase;
+             * evenly spread phases run as a plain interval after first call. All of them come from one timer, so their offsets are kept.
+             * First period boundary is one period after this call. Tables are read from interrupt, so they must be kept while group runs.
+             * Only one group runs on each object; with UTIMERLIB_SLOTS > 1 group takes one slot, and times are rounded to UTIMERLIB_TICK_US.
+             *
+             * @param	jobs		Timed functions
+             * @param	phases		Offset of each one into period, in microseconds, ascending and lower than period; equal ones are called together
+             * @param	count		Number of timed functions
+             * @param	period		Period shared by all of them, in microseconds
+             * @return	Handle of group, UTIMERLIB_INVALID_HANDLE if tables are not valid or group cannot be scheduled
+             */
+            uTimerLibHandle uTimerLib::setGroup_us(const uTimerLibDelegate * jobs, const unsigned long int * phases, unsigned char count, unsigned long int period) {
+                    if (count == 0 || period == 0 || phases[count - 1] >= period || phases[0] > 0xFFFFFFFFUL - period) { // Not valid
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    for (unsigned char i = 1; i < count; i++) {
+                            if (phases[i] < phases[i - 1]) {
+                                    return UTIMERLIB_INVALID_HANDLE;
+                            }
+                    }
+                    clearTimer(_groupHandle);
+                    _groupJobs = jobs;
+                    _groupPhases = phases;
+                    _groupCount = count;
+                    _groupPeriod = period;
+                    _groupIndex = 0;
+                    unsigned long int first = period + phases[0];
+                    _groupLoaded = _groupGap(0);
+                    _groupHandle = setInterval_us(uTimerLibDelegate(_groupFire, this), first);
+                    if (_groupHandle != UTIMERLIB_INVALID_HANDLE && _groupLoaded != first) {
+                            changePeriod_us(_groupHandle, _groupLoaded);
+                    }
+                    return _groupHandle;
+            }
+
+
+            /**
+             * \brief Time from phase of job i to next distinct phase of group, wrapping to first one on next period
+             *
+             * @param	i		Index of first job of a phase
+             * @return	Time in microseconds
+             */
+            unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_groupGap(unsigned char i) {
+                    unsigned long int phase = _groupPhases[i];
+                    while (i < _groupCount && _groupPhases[i] == phase) {
+                            i++;
+                    }
+                    return i < _groupCount ? _groupPhases[i] - phase : _groupPeriod - phase + _groupPhases[0];
+            }
+
+
+            /**
+             * \brief Group timed function: calls jobs of current phase and publishes step after the one that has just started
+             *
+             * It always runs inside timer interrupt, also on UTIMERLIB_DEFERRED mode, where jobs are queued.
+             *
+             * @param	self	uTimerLib object
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_groupFire(void * self) {
+                    uTimerLib * t = (uTimerLib *) self;
+                    unsigned char i = t->_groupIndex;
+                    unsigned long int phase = t->_groupPhases[i];
+                    do {
+                            t->_run(t->_groupJobs[i++]);
+                    } while (i < t->_groupCount && t->_groupPhases[i] == phase);
+                    if (i == t->_groupCount) {
+                            i = 0;
+                    }
+                    t->_groupIndex = i;
+                    unsigned long int gap = t->_groupGap(i);
+                    if (gap != t->_groupLoaded) {
+                            t->_groupLoaded = gap;
+                            t->changePeriod_us(t->_groupHandle, gap);
+                    }
+            }
+    #endif
+
+
+    #ifdef UTIMERLIB_PULSE_TRAIN
+            /**
+             * \brief Calls a callback function after each period of a table, stopping after last one
+             *
+             * Each period is loaded by timer interrupt when previous one ends, as changePeriod_us does, so there is no timer
+             * reconfiguration per pulse: on AVR Timer1 at 16MHz each period takes some microseconds of interrupt time.
+             * Table is read from interrupt, so it must be kept while train runs. First period must be longer than this call,
+             * as second one is published once timer is already running.
+             *
+             * @param	cb			Callback function to be called, once after each period
+             * @param	periods		Successive periods, in microseconds; a 0 ends train
+             * @param	count		Number of periods
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if table is empty or periods cannot be changed in running timer (low power clock on AVR Timer2)
+             */
+            uTimerLibHandle uTimerLib::setPulseTrain_us(uTimerLibDelegate cb, const unsigned long int * periods, unsigned int count) {
+                    clearTimer();
+                    _trainFn = NULL;
+                    _trainTable = periods;
+                    _trainCount = count;
+                    _trainIndex = 0;
+                    return _startTrain(cb);
+            }
+
+
+            /**
+             * \brief Calls a callback function after each period returned by a generator function, stopping when it returns 0
+             *
+             * Generator is called from timer interrupt, one period in advance, so it must be short. See setPulseTrain_us with a table.
+             *
+             * @param	cb			Callback function to be called, once after each period
+             * @param	next		Generator function, returning next period in microseconds, or 0 to end train
+             * @param	ctx			Pointer passed to next
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if first period is 0 or periods cannot be changed in running timer
+             */
+            uTimerLibHandle uTimerLib::setPulseTrain_us(uTimerLibDelegate cb, unsigned long int (* next)(void *), void * ctx) {
+                    clearTimer();
+                    _trainTable = NULL;
+                    _trainCount = 0;
+                    _trainCtx = ctx;
+                    _trainFn = next;
+                    return _startTrain(cb);
+            }
+
+
+            /**
+             * \brief Next period of pulse train, from table or generator
+             *
+             * @return	Period in microseconds, 0 when train has ended
+             */
+            unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_trainNext() {
+                    if (_trainFn != NULL) {
+                            return _trainFn(_trainCtx);
+                    }
+                    if (_trainIndex < _trainCount) {
+                            return _trainTable[_trainIndex++];
+                    }
+                    return 0;
+            }
+
+
+            /**
+             * \brief Starts pulse train: runs first period and publishes second one as next period
+             *
+             * @param	cb		Callback function to be called
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if it cannot be started
+             */
+            uTimerLibHandle uTimerLib::_startTrain(uTimerLibDelegate cb) {
+                    unsigned long int us = _trainNext();
+                    if (us == 0) {
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    _cb = cb;
+                    _type = UTIMERLIB_TYPE_INTERVAL;
+                    _periodSetup(us);
+                    #ifdef UTIMERLIB_OVERRUN
+                            _overrunPeriod = 0; // Each period is different
+                    #endif
+                    _attachInterrupt_us(us);
+                    uTimerLibHandle handle = _newHandle(us); // Clears any pending next period
+                    us = _trainNext();
+                    _trainStop = us == 0;
+                    if (!_trainStop && !_changePeriod_us(us)) {
+                            clearTimer();
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    _train = true;
+                    return handle;
+            }
+
+
+            /**
+             * \brief Called by timer interrupt after each pulse: period just started was already loaded, so this publishes following one
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_trainStep() {
+                    if (_trainStop) { // Last period has ended
+                            _train = false;
+                            clearTimer();
+                            return;
+                    }
+                    unsigned long int us = _trainNext();
+                    if (us == 0) {
+                            _trainStop = true;
+                    } else {
+                            _changePeriod_us(us);
+                    }
+            }
+    #endif
+
+
+    /**
+     * \brief Timer counts since current period started, for sub-microsecond time stamps without another timer
+     *
+     * Counts are read with interrupts disabled, so a loop or period ending while reading is not lost. With UTIMERLIB_SLOTS
+     * greater than 1 period is the scheduler one: a tick, or a wait on tickless mode. Counts run at getTickHz(), that
+     * may change when period changes.
+     *
+     * @return	Timer counts, 0 if timer is not running or device has no readable counter
+     */
+    unsigned long long uTimerLib::now_ticks() {
+            unsigned long long elapsed, total;
+            unsigned long int hz;
+            return _readPeriod(elapsed, total, hz) ? elapsed : 0;
+    }
+
+
+    /**
+     * \brief Time until current period ends, that is, until next timed function call with UTIMERLIB_SLOTS 1
+     *
+     * @return	Microseconds, rounded, 0 if timer is not running or device has no readable counter
+     */
+    unsigned long int uTimerLib::remaining_us() {
+            unsigned long long elapsed, total;
+            unsigned long int hz;
+            if (!_readPeriod(elapsed, total, hz) || elapsed >= total) {
+                    return 0;
+            }
+            total -= elapsed;
+            if (total >= 0xFFFFFFFFFFFFFFFFULL / 1000000) { // Would overflow 64 bits: counted in whole seconds
+                    total = total / hz * 1000000;
+            } else {
+                    total = (total * 1000000 + hz / 2) / hz;
+            }
+            return total > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (unsigned long int) total;
+    }
+
+
+    /**
+     * \brief Rate of now_ticks() counts
+     *
+     * @return	Counts per second, 0 if timer is not running or device has no readable counter
+     */
+    unsigned long int uTimerLib::getTickHz() {
+            unsigned long long elapsed, total;
+            unsigned long int hz;
+            return _readPeriod(elapsed, total, hz) ? hz : 0;
+    }
+
+
+    #ifdef UTIMERLIB_TICKLESS
+            /**
+             * \brief Sets how late a timed function may run, so its wake up is shared with other ones
+             *
+             * Timed function never runs before its time, but when another one wakes up scheduler up to slack later it runs then,
+             * saving a wake up. Hardware timer is programmed for earliest time any slot must run: its time plus its slack.
+             * Intervals keep their phase, as next time is counted from scheduled one, not from the late run.
+             *
+             * @param	handle		Handle returned by setXXX method
+             * @param	us			Allowed delay in microseconds, rounded down to UTIMERLIB_TICK_US and limited to UTIMERLIB_TICKLESS_MAX_US and less than period; 0 (default) to run on time
+             * @return	false if handle is not an active timed function
+             */
+            bool uTimerLib::setSlack_us(uTimerLibHandle handle, unsigned long int us) {
+                    unsigned char slot = (handle & 0xFF) - 1;
+                    bool found = false;
+
+                    UTIMERLIB_LOCK();
+                    if (slot < UTIMERLIB_SLOTS && _slots[slot].gen == (handle >> 8) && _slots[slot].type != UTIMERLIB_TYPE_OFF) {
+                            unsigned long int slack = us / UTIMERLIB_TICK_US;
+                            if (slack > (unsigned long int) (UTIMERLIB_TICKLESS_MAX_US / UTIMERLIB_TICK_US)) {
+                                    slack = UTIMERLIB_TICKLESS_MAX_US / UTIMERLIB_TICK_US;
+                            }
+                            if (slack >= _slots[slot].period) { // Less than a period, so intervals are not skipped
+                                    slack = _slots[slot].period - 1;
+                            }
+                            _advance();
+                            _slots[slot].slack = slack;
+                            found = true;
+                            // Wake up can be earlier now. Inside scheduler it will be programmed on exit
+                            if (!_inTick) {
+                                    long int wait = _nextWait();
+                                    _arm(wait > 0 ? wait : 1);
+                            }
+                    }
+                    UTIMERLIB_UNLOCK();
+                    return found;
+            }
+    #endif
+
+
+    #if UTIMERLIB_SLOTS > 1
+            /**
+             * \brief Converts microseconds to scheduler ticks, rounded; never 0 for a non 0 time
+             *
+             * @param	us		Time in microseconds
+             * @return	Time in UTIMERLIB_TICK_US ticks
+             */
+            unsigned long long uTimerLib::_usToTicks(unsigned long long us) {
+                    unsigned long long ticks = us / UTIMERLIB_TICK_US;
+                    if (us % UTIMERLIB_TICK_US >= UTIMERLIB_TICK_US / 2 || (ticks == 0 && us > 0)) {
+                            ticks++;
+                    }
+                    return ticks;
+            }
+
+
+            /**
+             * \brief Stores a timed function in a free slot and starts scheduler tick if needed
+             *
+             * Slot is activated writting its type as last step, so tick interrupt never sees an incomplete slot.
+             *
+             * @param	cb		Callback function to be called
+             * @param	type	UTIMERLIB_TYPE_TIMEOUT or UTIMERLIB_TYPE_INTERVAL
+             * @param	ticks	Time in UTIMERLIB_TICK_US ticks
+             * @return	Handle of timed function, UTIMERLIB_INVALID_HANDLE if there is no free slot
+             */
+            uTimerLibHandle uTimerLib::_addSlot(uTimerLibDelegate cb, unsigned char type, unsigned long long ticks) {
+                    if (ticks == 0 || ticks > 0x7FFFFFFFULL) { // Not valid
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    #ifdef UTIMERLIB_RTOS
+                            _rtosStart();
+                    #endif
+                    uTimerLibHandle handle = UTIMERLIB_INVALID_HANDLE;
+                    unsigned char i;
+
+                    UTIMERLIB_LOCK();
+                    bool start = (_type == UTIMERLIB_TYPE_OFF);
+                    #ifdef UTIMERLIB_TICKLESS
+                            start = start && !_inTick; // Scheduler has timer stopped while it runs
+                    #endif
+                    if (start) {
+                            // Timer is stopped: clearTimer() was called or all slots finished, so any slot is free
+                            for (i = 0; i < UTIMERLIB_SLOTS; i++) {
+                                    _slots[i].type = UTIMERLIB_TYPE_OFF;
+                            }
+                            #ifdef UTIMERLIB_TICKLESS
+                                    _base = micros();
+                            #endif
+                    }
+                    #ifdef UTIMERLIB_TICKLESS
+                            else {
+                                    // New count must be relative to same base than all others
+                                    _advance();
+                            }
+                    #endif
+                    for (i = 0; i < UTIMERLIB_SLOTS && _slots[i].type != UTIMERLIB_TYPE_OFF; i++);
+                    if (i < UTIMERLIB_SLOTS) {
+                            _slots[i].cb = cb;
+                            _slots[i].period = ticks;
+                            _slots[i].count = ticks;
+                            #ifdef UTIMERLIB_TICKLESS
+                                    _slots[i].slack = 0;
+                            #endif
+                            _slots[i].nextReady = false;
+                            _slots[i].gen++;
+                            _slots[i].type = type;
+                            handle = ((uTimerLibHandle) _slots[i].gen << 8) | (i + 1);
+
+                            #ifdef UTIMERLIB_TICKLESS
+                                    // New slot can be the nearest one. Inside scheduler it will be programmed on exit
+                                    if (!_inTick) {
+                                            long int wait = _nextWait();
+                                            _arm(wait > 0 ? wait : 1);
+                                    }
+                            #endif
+                    }
+                    UTIMERLIB_UNLOCK();
+
+                    #ifndef UTIMERLIB_TICKLESS
+                            if (start && handle != UTIMERLIB_INVALID_HANDLE) {
+                                    clearTimer();
+                                    _type = UTIMERLIB_TYPE_INTERVAL;
+                                    _periodSetup(UTIMERLIB_TICK_US);
+                                    _attachInterrupt_us(UTIMERLIB_TICK_US);
+                            }
+                    #endif
+                    return handle;
+            }
+
+
+            #ifndef UTIMERLIB_TICKLESS
+                    /**
+                     * \brief Scheduler tick: counts down all slots and calls the expired ones
+                     *
+                     * When no slot remains active hardware timer is stopped.
+                     */
+                    void UTIMERLIB_ISR_ATTR uTimerLib::_tick() {
+                            unsigned char i;
+                            for (i = 0; i < UTIMERLIB_SLOTS; i++) {
+                                    UTIMERLIB_ISR_LOCK();
+                                    if (_slots[i].type == UTIMERLIB_TYPE_OFF || --_slots[i].count != 0) {
+                                            UTIMERLIB_ISR_UNLOCK();
+                                            continue;
+                                    }
+                                    uTimerLibDelegate cb = _slots[i].cb;
+                                    if (_slots[i].type == UTIMERLIB_TYPE_TIMEOUT) {
+                                            _slots[i].type = UTIMERLIB_TYPE_OFF;
+                                    } else {
+                                            if (_slots[i].nextReady) {
+                                                    _slots[i].period = _slots[i].next;
+                                                    _slots[i].nextReady = false;
+                                            }
+                                            _slots[i].count = _slots[i].period;
+                                    }
+                                    UTIMERLIB_ISR_UNLOCK();
+                                    _run(cb);
+                            }
+                            // Callbacks may have added or cancelled any slot, so check it now
+                            UTIMERLIB_ISR_LOCK();
+                            for (i = 0; i < UTIMERLIB_SLOTS && _slots[i].type == UTIMERLIB_TYPE_OFF; i++);
+                            if (i == UTIMERLIB_SLOTS) {
+                                    clearTimer();
+                            }
+                            UTIMERLIB_ISR_UNLOCK();
+                    }
+
+            #else
+                    /**
+                     * \brief Scheduler wake up: calls all expired slots and programs hardware timer for next one
+                     *
+                     * Hardware timer is programmed as timeout, so it is already stopped here.
+                     * Slots due less than half a tick later are run in this same wake up, as _advance rounds them to due.
+                     * If no slot remains active it is not programmed again.
+                     */
+                    void UTIMERLIB_ISR_ATTR uTimerLib::_tick() {
+                            long int wait;
+                            unsigned char i;
+
+                            _inTick = true;
+                            for (;;) {
+                                    UTIMERLIB_ISR_LOCK();
+                                    _advance();
+                                    UTIMERLIB_ISR_UNLOCK();
+                                    for (i = 0; i < UTIMERLIB_SLOTS; i++) {
+                                            UTIMERLIB_ISR_LOCK();
+                                            if (_slots[i].type == UTIMERLIB_TYPE_OFF || _slots[i].count > 0) {
+                                                    UTIMERLIB_ISR_UNLOCK();
+                                                    continue;
+                                            }
+                                            uTimerLibDelegate cb = _slots[i].cb;
+                                            if (_slots[i].type == UTIMERLIB_TYPE_TIMEOUT) {
+                                                    _slots[i].type = UTIMERLIB_TYPE_OFF;
+                                            } else {
+                                                    if (_slots[i].nextReady) {
+                                                            _slots[i].period = _slots[i].next;
+                                                            _slots[i].nextReady = false;
+                                                    }
+                                                    // Keep phase; if we are more than a period late restart from now
+                                                    _slots[i].count += _slots[i].period;
+                                                    if (_slots[i].count <= 0) {
+                                                            _slots[i].count = _slots[i].period;
+                                                    }
+                                            }
+                                            UTIMERLIB_ISR_UNLOCK();
+                                            _run(cb);
+                                    }
+                                    UTIMERLIB_ISR_LOCK();
+                                    wait = _nextWait();
+                                    if (wait < 0 || wait >= (long int) (UTIMERLIB_TICK_US / 2)) {
+                                            break; // Still locked, so no slot is added between last check and programming timer
+                                    }
+                                    UTIMERLIB_ISR_UNLOCK();
+                            }
+                            _inTick = false;
+
+                            if (wait > 0) {
+                                    _arm(wait);
+                            }
+                            UTIMERLIB_ISR_UNLOCK();
+                    }
+
+
+                    /**
+                     * \brief Discounts elapsed ticks since last call from all active slots
+                     *
+                     * Elapsed time is rounded to nearest tick, so a hardware timer firing slightly early does not need another wake up.
+                     */
+                    void UTIMERLIB_ISR_ATTR uTimerLib::_advance() {
+                            long int elapsed = (long int) (micros() - _base);
+                            if (elapsed < (long int) (UTIMERLIB_TICK_US / 2)) {
+                                    return;
+                            }
+                            long int ticks = (elapsed + UTIMERLIB_TICK_US / 2) / UTIMERLIB_TICK_US;
+                            _base += ticks * UTIMERLIB_TICK_US;
+                            for (unsigned char i = 0; i < UTIMERLIB_SLOTS; i++) {
+                                    if (_slots[i].type != UTIMERLIB_TYPE_OFF) {
+                                            _slots[i].count -= ticks;
+                                    }
+                            }
+                    }
+
+
+                    /**
+                     * \brief Calculates time until nearest active slot must run: its count plus its slack
+                     *
+                     * @return	Microseconds to wait, up to UTIMERLIB_TICKLESS_MAX_US; 0 if any slot is due, -1 if there are no active slots
+                     */
+                    long int UTIMERLIB_ISR_ATTR uTimerLib::_nextWait() {
+                            long int next = 0;
+                            bool active = false;
+                            for (unsigned char i = 0; i < UTIMERLIB_SLOTS; i++) {
+                                    if (_slots[i].type != UTIMERLIB_TYPE_OFF) {
+                                            long int last = _slots[i].count + (long int) _slots[i].slack;
+                                            if (!active || last < next) {
+                                                    next = last;
+                                            }
+                                            active = true;
+                                    }
+                            }
+                            if (!active) {
+                                    return -1;
+                            }
+                            if (next <= 0) {
+                                    return 0;
+                            }
+                            if (next > (long int) (UTIMERLIB_TICKLESS_MAX_US / UTIMERLIB_TICK_US)) {
+                                    return UTIMERLIB_TICKLESS_MAX_US;
+                            }
+                            long int wait = next * UTIMERLIB_TICK_US - (long int) (micros() - _base);
+                            return wait > 0 ? wait : 0;
+                    }
+
+
+                    /**
+                     * \brief Programs hardware timer as timeout to wake up scheduler
+                     *
+                     * @param	us		Time to wait, in microseconds
+                     */
+                    void UTIMERLIB_ISR_ATTR uTimerLib::_arm(unsigned long int us) {
+                            clearTimer();
+                            _type = UTIMERLIB_TYPE_TIMEOUT;
+                            _periodSetup(us);
+                            _attachInterrupt_us(us);
+                    }
+            #endif
+
+    #else
+            /**
+             * \brief Generates handle for the single timed function
+             *
+             * @param	time	Requested time; 0 is not valid and gives UTIMERLIB_INVALID_HANDLE
+             * @return	Handle of timed function
+             */
+            uTimerLibHandle uTimerLib::_newHandle(unsigned long int time) {
+                    if (time == 0) { // Not valid
+                            return UTIMERLIB_INVALID_HANDLE;
+                    }
+                    _gen++;
+                    #ifdef UTIMERLIB_RELOAD
+                            _nextReady = false;
+                    #endif
+                    #ifdef UTIMERLIB_RTOS
+                            _rtosStart();
+                    #endif
+                    #ifdef UTIMERLIB_PULSE_TRAIN
+                            _train = false;
+                    #endif
+                    return ((uTimerLibHandle) _gen << 8) | 1;
+            }
+    #endif
+
+    #ifdef UTIMERLIB_RELOAD
+            /**
+             * \brief Publishes reload values for changePeriod_us; interrupt only reads them once _nextReady is set
+             *
+             * @param	overflows	Loops of new period
+             * @param	remaining	Remaining (or TOP) counts of new period
+             * @param	longLoops	Loops with one more count, on auto-reload timers
+             * @param	num			Fractional part of counts, numerator
+             * @param	den			Fractional part of counts, denominator
+             * @param	prescaler	Device prescaler value
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_setNext(unsigned long int overflows, unsigned long int remaining, unsigned long int longLoops, unsigned long int num, unsigned long int den, unsigned long int prescaler) {
+                    _nextReady = false;
+                    _nextOverflows = overflows;
+                    _nextRemaining = remaining;
+                    #if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+                            _nextLongLoops = longLoops;
+                    #endif
+                    _nextFracNum = num;
+                    _nextFracDen = den;
+                    _nextPrescaler = prescaler;
+                    _nextReady = true;
+            }
+
+
+            /**
+             * \brief Loads values published by _setNext as reload values; called by interrupt on period boundary when _nextReady is set
+             *
+             * Device prescaler, in _nextPrescaler, is loaded by caller.
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_takeNext() {
+                    __overflows = _nextOverflows;
+                    __remaining = _nextRemaining;
+                    #if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+                            _longLoops = _nextLongLoops;
+                    #endif
+                    _fracNum = _nextFracNum;
+                    _fracDen = _nextFracDen;
+                    _fracErr = _fracDen / 2;
+                    _nextReady = false;
+            }
+    #endif
+
+    /**
+     * \brief Converts microseconds to counts of a hz clock divided by 2^shift, rounded, using only integer math
+     *
+     * Result must fit in 32 bits; hardware implementations choose shift so it does.
+     *
+     * @param	us		Time in microseconds
+     * @param	hz		Timer input clock, in Hz
+     * @param	shift	Prescaler, as power of 2
+     * @return	Timer counts
+     */
+    inline unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_usToCounts(unsigned long int us, unsigned long int hz, unsigned char shift) {
+            if (hz % 1000000 == 0) {
+                    // Whole MHz clock, usual case: 32 bit math, split to not overflow
+                    unsigned long int mhz = hz / 1000000;
+                    return (us >> shift) * mhz + ((((us & ((1UL << shift) - 1)) * mhz) + ((1UL << shift) >> 1)) >> shift);
+            }
+            return ((unsigned long long) us * hz + (500000ULL << shift)) / (1000000ULL << shift);
+    }
+
+    /**
+     * \brief Converts microseconds to whole counts of a hz clock divided by 2^shift, returning fraction for _fracStep
+     *
+     * Result must fit in 32 bits; hardware implementations choose shift so it does.
+     *
+     * @param	us		Time in microseconds
+     * @param	hz		Timer input clock, in Hz
+     * @param	shift	Prescaler, as power of 2
+     * @param	num		Returns fractional part of counts, numerator
+     * @param	den		Returns fractional part of counts, denominator
+     * @return	Timer counts, truncated, never 0
+     */
+    unsigned long int UTIMERLIB_ISR_ATTR uTimerLib::_usToCountsFrac(unsigned long int us, unsigned long int hz, unsigned char shift, unsigned long int & num, unsigned long int & den) {
+            unsigned long int counts;
+            if (hz % 1000000 == 0) {
+                    // Whole MHz clock: fraction is exact, in 1 / 2^shift counts
+                    unsigned long int mhz = hz / 1000000;
+                    unsigned long int low = (us & ((1UL << shift) - 1)) * mhz;
+                    num = low & ((1UL << shift) - 1);
+                    den = 1UL << shift;
+                    counts = (us >> shift) * mhz + (low >> shift);
+            } else {
+                    // Other clocks: fraction in 1 / 1000000 counts
+                    unsigned long long x = (unsigned long long) us * hz;
+                    num = (x % (1000000ULL << shift)) >> shift;
+                    den = 1000000;
+                    counts = x / (1000000ULL << shift);
+            }
+            if (counts == 0) {
+                    num = 0;
+                    return 1;
+            }
+            return counts;
+    }
+
+    /**
+     * \brief Converts a 64 bit microseconds time to whole counts of a hz clock divided by 2^shift, storing fraction for _fracStep
+     *
+     * Whole seconds part is exact, in 1 / 2^shift counts, as usual; any microseconds left changes fraction to 1 / 1000000 counts.
+     *
+     * @param	us		Time in microseconds
+     * @param	hz		Timer input clock, in Hz
+     * @param	shift	Prescaler, as power of 2
+     * @return	Timer counts, truncated, never 0
+     */
+    unsigned long long uTimerLib::_longToCounts(unsigned long long us, unsigned long int hz, unsigned char shift) {
+            unsigned long long x = (us / 1000000) * hz;
+            unsigned long int r = us % 1000000;
+            unsigned long long counts = x >> shift;
+            if (r == 0) {
+                    _fracNum = x & ((1UL << shift) - 1);
+                    _fracDen = 1UL << shift;
+            } else {
+                    // Remainder of seconds part plus microseconds part, both in 1 / (1000000 * 2^shift) counts
+                    unsigned long long rem = (x & ((1UL << shift) - 1)) * 1000000 + (unsigned long long) r * hz;
+                    counts += rem / (1000000ULL << shift);
+                    _fracNum = (rem % (1000000ULL << shift)) >> shift;
+                    _fracDen = 1000000;
+            }
+            _fracErr = _fracDen / 2;
+            return counts ? counts : 1;
+    }
+
+    #ifndef UTIMERLIB_US_ONLY
+            /**
+             * \brief Attaches interrupt for any 64 bit microseconds time
+             *
+             * Times that fit in 32 bits use _attachInterrupt_us, with its finest prescaler; longer ones _attachInterrupt_long.
+             *
+             * @param	us		Time in microseconds
+             */
+            void uTimerLib::_attachInterrupt_us64(unsigned long long us) {
+                    if (us <= 0xFFFFFFFFULL) {
+                            _attachInterrupt_us((unsigned long int) us);
+                    } else {
+                            _attachInterrupt_long(us);
+                    }
+            }
+    #endif
+
+    /**
+     * \brief Bresenham step of the fractional part of period, to be called once on each period
+     *
+     * Timers can only count whole counts, so periods are truncated and, when accumulated fraction reaches
+     * a whole count, one period is one count longer. This way long-run average period is exact and never drifts.
+     *
+     * @return	1 if this period must be one count longer, 0 if not
+     */
+    unsigned char UTIMERLIB_ISR_ATTR uTimerLib::_fracStep() {
+            _fracErr += _fracNum;
+            if (_fracErr >= _fracDen) {
+                    _fracErr -= _fracDen;
+                    return 1;
+            }
+            return 0;
+    }
+
+    /**
+     * \brief Chooses smallest prescaler that counts us microseconds in one timer loop, or biggest one if none does
+     *
+     * Also stores fractional part of period for _fracStep
+     *
+     * @param	us		Time in microseconds
+     * @param	hz		Timer input clock, in Hz
+     * @param	shifts	Available prescalers, as powers of 2, in ascending order
+     * @param	n		Number of available prescalers
+     * @param	top		Maximum counts in one timer loop
+     * @param	counts	Returns timer counts for chosen prescaler, truncated, never 0
+     * @return	Index of chosen prescaler in shifts
+     */
+    unsigned char uTimerLib::_fitPrescaler(unsigned long int us, unsigned long int hz, const unsigned char * shifts, unsigned char n, unsigned long int top, unsigned long int & counts) {
+            unsigned char k = _fitPrescaler(us, hz, shifts, n, top, counts, _fracNum, _fracDen);
+            _fracErr = _fracDen / 2;
+            return k;
+    }
+
+    /**
+     * \brief Chooses smallest prescaler that counts us microseconds in one timer loop, or biggest one if none does
+     *
+     * Running period is not changed, so it can be used by changePeriod_us
+     *
+     * @param	us		Time in microseconds
+     * @param	hz		Timer input clock, in Hz
+     * @param	shifts	Available prescalers, as powers of 2, in ascending order
+     * @param	n		Number of available prescalers
+     * @param	top		Maximum counts in one timer loop
+     * @param	counts	Returns timer counts for chosen prescaler, truncated, never 0
+     * @param	num		Returns fractional part of counts, numerator
+     * @param	den		Returns fractional part of counts, denominator
+     * @return	Index of chosen prescaler in shifts
+     */
+    unsigned char UTIMERLIB_ISR_ATTR uTimerLib::_fitPrescaler(unsigned long int us, unsigned long int hz, const unsigned char * shifts, unsigned char n, unsigned long int top, unsigned long int & counts, unsigned long int & num, unsigned long int & den) {
+            // Start from biggest prescaler, so smaller ones are only tried when they cannot overflow
+            unsigned char k = n - 1;
+            counts = _usToCounts(us, hz, shifts[k]);
+            while (k > 0 && counts <= top) {
+                    if (counts > (top >> (shifts[k] - shifts[k - 1]))) { // Smaller prescaler would overflow, even 32 bits on 32 bit timers
+                            break;
+                    }
+                    unsigned long int next = _usToCounts(us, hz, shifts[k - 1]);
+                    if (next > top) {
+                            break;
+                    }
+                    counts = next;
+                    k--;
+            }
+            counts = _usToCountsFrac(us, hz, shifts[k], num, den);
+            return k;
+    }
+
+    #if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+            /**
+             * \brief Converts a frequency to whole counts of a clk clock divided by 2^shift, returning fraction for _fracStep
+             *
+             * Fraction is exact, in 1 / (hz * 2^shift) counts, unless that does not fit in 32 bits.
+             *
+             * @param	hz		Frequency in Hz
+             * @param	clk		Timer input clock, in Hz
+             * @param	shift	Prescaler, as power of 2
+             * @param	num		Returns fractional part of counts, numerator
+             * @param	den		Returns fractional part of counts, denominator
+             * @return	Timer counts of each period, truncated, never 0
+             */
+            unsigned long int uTimerLib::_hzToCountsFrac(unsigned long int hz, unsigned long int clk, unsigned char shift, unsigned long int & num, unsigned long int & den) {
+                    unsigned long long d = (unsigned long long) hz << shift;
+                    unsigned long int counts = clk / d;
+                    unsigned long long r = clk % d;
+                    while (d > 0xFFFFFFFFULL) {
+                            d >>= 1;
+                            r >>= 1;
+                    }
+                    num = (unsigned long int) r;
+                    den = (unsigned long int) d;
+                    if (counts == 0) {
+                            num = 0;
+                            return 1;
+                    }
+                    return counts;
+            }
+
+            /**
+             * \brief Chooses smallest prescaler that counts a period of hz frequency in one timer loop, or biggest one if none does
+             *
+             * Also stores fractional part of period for _fracStep
+             *
+             * @param	hz		Frequency in Hz
+             * @param	clk		Timer input clock, in Hz
+             * @param	shifts	Available prescalers, as powers of 2, in ascending order
+             * @param	n		Number of available prescalers
+             * @param	top		Maximum counts in one timer loop
+             * @param	counts	Returns timer counts for chosen prescaler, truncated, never 0
+             * @return	Index of chosen prescaler in shifts
+             */
+            unsigned char uTimerLib::_fitPrescalerHz(unsigned long int hz, unsigned long int clk, const unsigned char * shifts, unsigned char n, unsigned long int top, unsigned long int & counts) {
+                    unsigned char k = 0;
+                    while (k < n - 1 && clk / ((unsigned long long) hz << shifts[k]) > top) {
+                            k++;
+                    }
+                    counts = _hzToCountsFrac(hz, clk, shifts[k], _fracNum, _fracDen);
+                    _fracErr = _fracDen / 2;
+                    return k;
+            }
+
+            /**
+             * \brief Frequency given by a period of counts plus num / den counts, of a clk clock divided by 2^shift
+             *
+             * @param	clk		Timer input clock, in Hz
+             * @param	shift	Prescaler, as power of 2
+             * @param	counts	Whole timer counts of each period
+             * @param	num		Fractional part of counts, numerator
+             * @param	den		Fractional part of counts, denominator
+             * @return	Frequency in mHz, rounded
+             */
+            unsigned long int uTimerLib::_milliHz(unsigned long int clk, unsigned char shift, unsigned long long counts, unsigned long int num, unsigned long int den) {
+                    while (den > 0xFFFFFFUL) { // clk * 1000 * den fits in 64 bits; lost fraction is below 2^-24 counts
+                            num >>= 1;
+                            den >>= 1;
+                    }
+                    unsigned long long period = (counts * den + num) << shift; // In 1 / den counts of clk
+                    return (unsigned long int) (((unsigned long long) clk * 1000 * den + period / 2) / period);
+            }
+    #endif
+
+    /**
+     * \brief Splits a period in hardware timer loops as equal as possible, so none of them is too short to be reprogrammed
+     *
+     * Period is loops loops of top + 1 counts, being first longLoops of them one count longer.
+     * There is always at least one short loop, that can be made one count longer by _fracStep.
+     * Each loop is at least half timer size when there are many of them, and no 64 bit division is used.
+     *
+     * @param	counts		Timer counts of whole period, not 0
+     * @param	bits		Timer counter width, up to 32
+     * @param	loops		Returns number of loops
+     * @param	top			Returns TOP (counts - 1) of short loops
+     * @param	longLoops	Returns number of long loops
+     */
+    void UTIMERLIB_ISR_ATTR uTimerLib::_splitLoops(unsigned long long counts, unsigned char bits, unsigned long int & loops, unsigned long int & top, unsigned long int & longLoops) {
+            if (counts < (1ULL << bits)) { // One loop, the usual case for short periods: no division
+                    loops = 1;
+                    top = counts - 1;
+                    longLoops = 0;
+                    return;
+            }
+            loops = (counts >> bits) + 1;
+            // Counts missing to fill all loops, up to one loop, shared between all of them; kept minus one so a 32 bit loop fits
+            unsigned long int missing = ((unsigned long long) loops << bits) - counts - 1;
+            unsigned long int shorten = missing / loops + 1;
+            top = (unsigned long int) ((1ULL << bits) - shorten - 1);
+            longLoops = loops * shorten - missing - 1;
+    }
+
+    #if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+            /**
+             * \brief Starts a new period of hardware auto-reload loops, adding fraction count when needed
+             */
+            void uTimerLib::_startPeriod() {
+                    _periodLongLoops = _longLoops + _fracStep();
+                    _loadRemaining();
+            }
+
+
+            /**
+             * \brief Position in current period of hardware auto-reload loops, for _readPeriod
+             *
+             * Must be called with interrupts disabled.
+             *
+             * @param	count		Timer count in current loop
+             * @param	pending		Current loop has ended but its interrupt has not run yet; count must be read after checking it
+             * @param	elapsed		Returns counts since period started
+             * @param	total		Returns counts of whole period
+             */
+            void uTimerLib::_loopsPosition(unsigned long int count, bool pending, unsigned long long & elapsed, unsigned long long & total) {
+                    unsigned long int done = __overflows - _overflows; // Loops ended on this period
+                    if (pending && ++done >= __overflows) { // So has period: count is already on next one
+                            done = 0;
+                    }
+                    total = (unsigned long long) __overflows * (__remaining + 1) + _periodLongLoops;
+                    elapsed = (unsigned long long) done * (__remaining + 1) + (done < _periodLongLoops ? done : _periodLongLoops) + count;
+            }
+    #endif
+
+    /**
+     * \brief Calls a timed function, or queues it for dispatch() on UTIMERLIB_DEFERRED mode
+     *
+     * A call is coalesced, and only counted, when same function is already last pending one or queue is full.
+     *
+     * @param	cb		Callback function to be called
+     */
+    inline void UTIMERLIB_ISR_ATTR uTimerLib::_run(const uTimerLibDelegate & cb) {
+            #ifdef UTIMERLIB_DEFERRED
+                    #ifdef UTIMERLIB_GROUP
+                            if (cb._fn == _groupFire) { // Steps its period on time, and queues its jobs
+                                    cb();
+                                    return;
+                            }
+                    #endif
+                    UTIMERLIB_ISR_LOCK();
+                    unsigned char head = _queueHead;
+                    unsigned char last = (unsigned char) (head - 1) & (UTIMERLIB_QUEUE_SIZE - 1);
+                    if ((head != _queueTail && _queueFn[last] == cb._fn && _queueCtx[last] == cb._ctx) || (unsigned char) (head - _queueTail) == UTIMERLIB_QUEUE_SIZE) {
+                            _coalesced++;
+                            UTIMERLIB_ISR_UNLOCK();
+                            return;
+                    }
+                    _queueFn[head & (UTIMERLIB_QUEUE_SIZE - 1)] = cb._fn;
+                    _queueCtx[head & (UTIMERLIB_QUEUE_SIZE - 1)] = cb._ctx;
+                    _queueHead = head + 1; // Publish it once stored
+                    UTIMERLIB_ISR_UNLOCK();
+            #else
+                    cb();
+            #endif
+    }
+
+
+    /**
+     * \brief Runs scheduler tick, with UTIMERLIB_SLOTS > 1, or the single timed function
+     */
+    inline void UTIMERLIB_ISR_ATTR uTimerLib::_fire() {
+            #if UTIMERLIB_SLOTS > 1
+                    _tick();
+            #else
+                    _run(_cb);
+            #endif
+    }
+
+
+    // STM32 parts of ST's core can be Cortex-M0 / M0+ (F0, G0, L0...), without DWT; Roger Clark core is for Cortex-M3 / M4 only
+    #if (defined(UTIMERLIB_STATS) || defined(UTIMERLIB_OVERRUN)) && (defined(ARDUINO_ARCH_SAM) || defined(__SAMD51__) || ((defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)) && (!defined(BOARD_NAME) || (defined(__CORTEX_M) && __CORTEX_M >= 3))))
+            // Cortex-M3 and up DWT cycle counter, by address as it is the same on all of them and some cores have no CMSIS
+            #define UTIMERLIB_DEMCR (*(volatile uint32_t *) 0xE000EDFC)
+            #define UTIMERLIB_DWT_CTRL (*(volatile uint32_t *) 0xE0001000)
+            #define UTIMERLIB_DWT_CYCCNT (*(volatile uint32_t *) 0xE0001004)
+
+            /**
+             * \brief Starts DWT cycle counter, if it is not running yet
+             */
+            static inline void _dwtStart() {
+                    UTIMERLIB_DEMCR |= 1UL << 24; // TRCENA
+                    UTIMERLIB_DWT_CTRL |= 1; // CYCCNTENA
+            }
+    #endif
+
+    #ifdef UTIMERLIB_OVERRUN
+            #ifdef ARDUINO_ARCH_AVR
+                    // No clock runs inside timer interrupt (micros() stops), so pending timer interrupt is checked instead
+                    #define UTIMERLIB_OVERRUN_CLOCK() 0
+                    #define UTIMERLIB_OVERRUN_PER_US 1UL
+            #elif defined(UTIMERLIB_DWT_CYCCNT) && defined(F_CPU)
+                    // Only where DWT exists; Cortex-M0 / M0+ STM32 use micros(), as SysTick is reloaded each ms
+                    #define UTIMERLIB_OVERRUN_CLOCK() UTIMERLIB_DWT_CYCCNT
+                    #define UTIMERLIB_OVERRUN_PER_US (F_CPU / 1000000)
+            #else
+                    #define UTIMERLIB_OVERRUN_CLOCK() micros()
+                    #define UTIMERLIB_OVERRUN_PER_US 1UL
+            #endif
+
+            /**
+             * \brief Sets what happens to interval periods ending while timed function is still running
+             *
+             * @param	policy		UTIMERLIB_OVERRUN_CONTINUE (default), UTIMERLIB_OVERRUN_SKIP or UTIMERLIB_OVERRUN_CATCHUP
+             */
+            void uTimerLib::setOverrunPolicy(unsigned char policy) {
+                    _overrunPolicy = policy;
+            }
+
+
+            /**
+             * \brief Gets number of missed ticks: interval periods that ended while timed function was still running
+             *
+             * They are counted on every policy, so a saturated timed function can be told apart from a correct one.
+             *
+             * @return	Missed ticks since start
+             */
+            unsigned long int uTimerLib::getMissed() {
+                    UTIMERLIB_LOCK();
+                    unsigned long int missed = _missed;
+                    UTIMERLIB_UNLOCK();
+                    return missed;
+            }
+
+
+            /**
+             * \brief Keeps interval period being programmed, in UTIMERLIB_OVERRUN_CLOCK units, to measure timed function against it
+             *
+             * @param	us		Period being programmed, in microseconds
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_overrunSetup(unsigned long long us) {
+                    _overrunPeriod = (_type == UTIMERLIB_TYPE_INTERVAL && us <= 0xFFFFFFFFUL / UTIMERLIB_OVERRUN_PER_US) ? us * UTIMERLIB_OVERRUN_PER_US : 0;
+                    _overrunSkip = false;
+                    _overrunFresh = true;
+                    #if !defined(ARDUINO_ARCH_AVR) && defined(UTIMERLIB_DWT_CYCCNT) && defined(F_CPU)
+                            _dwtStart();
+                    #endif
+            }
+
+
+            /**
+             * \brief Checks timer interrupt before calling timed function
+             *
+             * @return	false if timed function must not be called
+             */
+            inline bool UTIMERLIB_ISR_ATTR uTimerLib::_overrunEnter() {
+                    if (_overrunSkip) { // Pending timer interrupt of a period that ended while timed function was running
+                            _overrunSkip = false;
+                            return false;
+                    }
+                    _overrunFresh = false;
+                    return true;
+            }
+
+
+            /**
+             * \brief Counts periods that ended while timed function was running, as missed ticks, and applies overrun policy
+             *
+             * First of them is still pending as timer interrupt: it is the late call of UTIMERLIB_OVERRUN_CONTINUE, last one of
+             * UTIMERLIB_OVERRUN_CATCHUP burst, and it is dropped on UTIMERLIB_OVERRUN_SKIP. Nothing is done if timed function has
+             * programmed timer again. On AVR that pending interrupt is all that is known, so one missed tick is counted each time.
+             *
+             * @param	start	UTIMERLIB_OVERRUN_CLOCK() when timed function was called
+             */
+            inline void UTIMERLIB_ISR_ATTR uTimerLib::_overrunExit(unsigned long int start) {
+                    #ifdef ARDUINO_ARCH_AVR
+                            (void) start;
+                            if (_overrunFresh || _overrunPeriod == 0 || _type != UTIMERLIB_TYPE_INTERVAL || !_overrunPending()) {
+                                    return;
+                            }
+                            unsigned long int missed = 1;
+                    #else
+                            unsigned long int elapsed = UTIMERLIB_OVERRUN_CLOCK() - start;
+                            if (_overrunFresh || _overrunPeriod == 0 || _type != UTIMERLIB_TYPE_INTERVAL || elapsed < _overrunPeriod) {
+                                    return;
+                            }
+                            unsigned long int missed = elapsed / _overrunPeriod;
+                    #endif
+                    UTIMERLIB_ISR_LOCK();
+                    _missed += missed;
+                    UTIMERLIB_ISR_UNLOCK();
+                    UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_OVERRUN);
+                    if (_overrunPolicy == UTIMERLIB_OVERRUN_SKIP) {
+                            _overrunSkip = true;
+                    } else if (_overrunPolicy == UTIMERLIB_OVERRUN_CATCHUP) {
+                            for (unsigned long int i = 1; i < missed && i <= UTIMERLIB_OVERRUN_BURST; i++) {
+                                    _fire();
+                            }
+                    }
+            }
+    #endif
+
+
+    /**
+     * \brief Calls timed function from timer interrupt, measuring it when UTIMERLIB_STATS is defined
+     *
+     * With UTIMERLIB_SLOTS > 1 scheduler tick always runs here; it uses _run for each due slot.
+     * With UTIMERLIB_OVERRUN overrun policy is applied when it returns.
+     */
+    inline void UTIMERLIB_ISR_ATTR uTimerLib::_callback() {
+            _calls++;
+            #ifdef UTIMERLIB_OVERRUN
+                    if (!_overrunEnter()) {
+                            return;
+                    }
+                    unsigned long int begin = UTIMERLIB_OVERRUN_CLOCK();
+            #endif
+            UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_FIRE);
+            #ifdef UTIMERLIB_STATS
+                    unsigned long int start = _statsCycles();
+                    _fire();
+                    unsigned long int cycles = _statsElapsed(start);
+                    UTIMERLIB_ISR_LOCK();
+                    _stats.callbacks++;
+                    _statsTotal += cycles;
+                    if (cycles < _stats.callbackMin) {
+                            _stats.callbackMin = cycles;
+                    }
+                    if (cycles > _stats.callbackMax) {
+                            _stats.callbackMax = cycles;
+                    }
+                    if (cycles >= _statsPeriod) {
+                            _stats.overruns++;
+                            #ifndef UTIMERLIB_OVERRUN
+                                    UTIMERLIB_TRACE_EVENT(UTIMERLIB_TRACE_OVERRUN);
+                            #endif
+                    }
+                    UTIMERLIB_ISR_UNLOCK();
+            #else
+                    _fire();
+            #endif
+            #ifdef UTIMERLIB_OVERRUN
+                    _overrunExit(begin);
+            #endif
+            #ifdef UTIMERLIB_RTOS
+                    _rtosNotify();
+            #endif
+            #ifdef UTIMERLIB_PULSE_TRAIN
+                    if (_train) {
+                            _trainStep();
+                    }
+            #endif
+    }
+
+    #ifdef UTIMERLIB_DEFERRED
+            /**
+             * \brief Runs timed functions queued by timer interrupt on UTIMERLIB_DEFERRED mode
+             *
+             * Call it from loop(), or from one task; only one context may call it. Calls queued while running wait for next call.
+             * On UTIMERLIB_RTOS mode library task calls it, so it must not be called.
+             *
+             * @return	Number of timed functions run
+             */
+            unsigned char uTimerLib::dispatch() {
+                    unsigned char head = _queueHead;
+                    unsigned char n = 0;
+                    while (_queueTail != head) {
+                            void (* fn)(void *) = _queueFn[_queueTail & (UTIMERLIB_QUEUE_SIZE - 1)];
+                            void * ctx = _queueCtx[_queueTail & (UTIMERLIB_QUEUE_SIZE - 1)];
+                            _queueTail = _queueTail + 1; // Free it before calling, so a new call of same function is queued again
+                            fn(ctx);
+                            n++;
+                    }
+                    return n;
+            }
+
+
+            /**
+             * \brief Gets number of coalesced calls: not queued because same function was already pending or queue was full
+             *
+             * @return	Coalesced calls since start
+             */
+            unsigned long int uTimerLib::getCoalesced() {
+                    UTIMERLIB_LOCK();
+                    unsigned long int coalesced = _coalesced;
+                    UTIMERLIB_UNLOCK();
+                    return coalesced;
+            }
+
+
+            #ifdef UTIMERLIB_RTOS
+                    /**
+                     * \brief Creates task that runs timed functions on UTIMERLIB_RTOS mode, if it is not already running
+                     *
+                     * Pinned to UTIMERLIB_RTOS_CORE on ESP32.
+                     */
+                    void uTimerLib::_rtosStart() {
+                            if (_rtosTask != NULL) {
+                                    return;
+                            }
+                            #ifdef ARDUINO_ARCH_ESP32
+                                    xTaskCreatePinnedToCore(_rtosLoop, "uTimerLib", UTIMERLIB_RTOS_STACK, this, UTIMERLIB_RTOS_PRIORITY, &_rtosTask, UTIMERLIB_RTOS_CORE);
+                            #else
+                                    xTaskCreate(_rtosLoop, "uTimerLib", UTIMERLIB_RTOS_STACK, this, UTIMERLIB_RTOS_PRIORITY, &_rtosTask);
+                            #endif
+                    }
+
+
+                    /**
+                     * \brief Wakes up timed functions task from timer interrupt, when there are queued calls
+                     *
+                     * A task notification is a counter on task itself, so several interrupts before task runs need no queue.
+                     */
+                    void UTIMERLIB_ISR_ATTR uTimerLib::_rtosNotify() {
+                            if (_rtosTask == NULL || _queueHead == _queueTail) {
+                                    return;
+                            }
+                            BaseType_t woken = pdFALSE;
+                            vTaskNotifyGiveFromISR(_rtosTask, &woken);
+                            if (woken) {
+                                    portYIELD_FROM_ISR();
+                            }
+                    }
+
+
+                    /**
+                     * \brief Timed functions task: runs queued calls, then waits for timer interrupt
+                     *
+                     * @param	self	uTimerLib object
+                     */
+                    void uTimerLib::_rtosLoop(void * self) {
+                            for (;;) {
+                                    ((uTimerLib *) self)->dispatch();
+                                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                            }
+                    }
+            #endif
+    #endif
+
+    #ifdef UTIMERLIB_STATS
+            /**
+             * \brief Gets timer statistics since start or last resetStats() call
+             *
+             * @return	Copy of statistics, taken at once
+             */
+            uTimerLibStats uTimerLib::getStats() {
+                    UTIMERLIB_LOCK();
+                    uTimerLibStats stats = _stats;
+                    unsigned long long total = _statsTotal;
+                    UTIMERLIB_UNLOCK();
+                    if (stats.isrCount == 0) {
+                            stats.latencyMin = 0;
+                    }
+                    if (stats.callbacks == 0) {
+                            stats.callbackMin = 0;
+                    } else {
+                            stats.callbackMean = total / stats.callbacks;
+                    }
+                    return stats;
+            }
+
+
+            /**
+             * \brief Clears timer statistics
+             */
+            void uTimerLib::resetStats() {
+                    UTIMERLIB_LOCK();
+                    _stats = {0, 0xFFFFFFFF, 0, 0, 0xFFFFFFFF, 0, 0, 0};
+                    _statsTotal = 0;
+                    UTIMERLIB_UNLOCK();
+            }
+
+
+            /**
+             * \brief Keeps hardware timer period, to detect overruns, and starts cycle counter if needed
+             *
+             * @param	us		Period being programmed, in microseconds
+             */
+            void UTIMERLIB_ISR_ATTR uTimerLib::_statsSetup(unsigned long long us) {
+                    #ifdef F_CPU
+                            unsigned long long cycles = us * (F_CPU / 1000000);
+                            _statsPeriod = cycles > 0xFFFFFFFF ? 0xFFFFFFFF : cycles;
+                    #endif
+                    #ifdef UTIMERLIB_DWT_CYCCNT
+                            _dwtStart();
+                    #endif
+            }
+
+
+            /**
+             * \brief Counts one timer interrupt
+             *
+             * @param	latency		ISR entry latency, in CPU cycles
+             */
+            inline void UTIMERLIB_ISR_ATTR uTimerLib::_statsIsr(unsigned long int latency) {
+                    UTIMERLIB_ISR_LOCK();
+                    _stats.isrCount++;
+                    if (latency < _stats.latencyMin) {
+                            _stats.latencyMin = latency;
+                    }
+                    if (latency > _stats.latencyMax) {
+                            _stats.latencyMax = latency;
+                    }
+                    UTIMERLIB_ISR_UNLOCK();
+            }
+    #endif
+
+    #if defined(UTIMERLIB_SAMPLING) && (defined(_SAMD21_) || defined(__SAMD51__))
+            /**
+             * \brief Passes filled half of sampling buffer to its function; called from DMA interrupt at end of each half
+             */
+            void uTimerLib::_dmaInterrupt() {
+                    uint16_t * samples = _dmaBuffer + (_dmaNext ? _dmaHalf : 0);
+                    _dmaNext ^= 1;
+                    _calls++;
+                    _dmaCb(samples, _dmaHalf);
+            }
+    #endif
+
+    #define UTIMERLIB_HW_COMPILE
+
+    // Now load each hardware variation support:
+
+    #if (defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_AVR)) && !defined(ARDUINO_attiny) && !defined(ARDUINO_AVR_ATTINYX4) && !defined(ARDUINO_AVR_ATTINYX5) && !defined(ARDUINO_AVR_ATTINYX7) && !defined(ARDUINO_AVR_ATTINYX8) && !defined(ARDUINO_AVR_ATTINYX61) && !defined(ARDUINO_AVR_ATTINY43) && !defined(ARDUINO_AVR_ATTINY828) && !defined(ARDUINO_AVR_ATTINY1634) && !defined(ARDUINO_AVR_ATTINYX313)
+            #include "hardware/uTimerLib.AVR.cpp"
+    #endif
+
+    #if defined(ARDUINO_ARCH_AVR) && (defined(ARDUINO_attiny) ||defined(ARDUINO_AVR_ATTINYX5))
+            #include "hardware/uTimerLib.ATTINY.cpp"
+    #endif
+
+    #if defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)
+        #include "hardware/uTimerLib.STM32.cpp"
+    #endif
+
+    #if defined(ARDUINO_ARCH_ESP8266)
+            #include "hardware/uTimerLib.ESP.cpp"
+    #endif
+    #if defined(ARDUINO_ARCH_ESP32)
+            #include "hardware/uTimerLib.ESP32.cpp"
+    #endif
+    #ifdef ARDUINO_ARCH_SAM
+            #include "hardware/uTimerLib.SAM.cpp"
+    #endif
+    #ifdef _SAMD21_
+            #include "hardware/uTimerLib.SAMD21.cpp"
+    #endif
+    #ifdef __SAMD51__
+            #include "hardware/uTimerLib.SAMD51.cpp"
+    #endif
+
+
+    #if !defined(__AVR_ATmega32U4__) && !defined(ARDUINO_ARCH_AVR) && !defined(_VARIANT_ARDUINO_STM32_) && !defined(ARDUINO_ARCH_STM32) && !defined(ARDUINO_ARCH_ESP8266) && !defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_ARCH_SAM) && !defined(_SAMD21_) && !defined(__SAMD51__) && !defined(ARDUINO_attiny) && !defined(ARDUINO_AVR_ATTINYX5)
+        #include "hardware/uTimerLib.UNSUPPORTED.cpp"
+    #endif
+
+#endif
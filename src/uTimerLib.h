@@ -1,158 +1,1294 @@
-/**
- * \mainpage
- * \brief Arduino tiny and cross-device compatible timer library.
- *
- * Timers used by each microcontroller:
- *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
- *		* Atmel AVR 32U4:	Timer3 (4rd timer)
- *		* Atmel AVR other:	Timer2 (3rd timer)
- *		* STM32:			Timer3 (3rd timer)
- *		* SAM (Due):		TC3 (Timer1, channel 0)
- *		* ESP8266:			OS Timer, one slot of seven available (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
- *		* ESP32:			OS Timer, one slot of software timer.
- *		* SAMD21:			Timer 4, CC0 (TC3). See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
- *		* SAMD51:			Timer 2 (TC1), 16 bits mode (See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
- *
- * You have public TimerLib variable with following methods:
- *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
- *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
- *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
- *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
- *		* TimerLib.clearTimer();* : will clear any timed function if exists.
- *
- * @copyright Naguissa
- * @author Naguissa
- * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
- * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
- * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
- * @version 1.6.1
- */
-/** \file uTimerLib.h
- *   \brief uTimerLib header file
- */
-#ifndef _uTimerLib_
-	/**
-	 * \brief Prevent multiple inclussion
-	 */
-	#define _uTimerLib_
-
-	#include "Arduino.h"
-
-	#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
-		#include <Ticker.h>  //Ticker Library
-	#endif
-	// Operation modes
-	/**
-	 * \brief Internal status
-	 */
-	#define UTIMERLIB_TYPE_OFF 0
-	/**
-	 * \brief Internal status
-	 */
-	#define UTIMERLIB_TYPE_TIMEOUT 1
-	/**
-	 * \brief Internal status
-	 */
-	#define UTIMERLIB_TYPE_INTERVAL 2
-
-	#ifdef _VARIANT_ARDUINO_STM32_
-		#include "HardwareTimer.h"
-
-		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-		#ifdef BOARD_NAME
-			// Private member
-
-		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-		#else
-			extern HardwareTimer Timer3;
-		#endif
-	#endif
-
-	class uTimerLib {
-		public:
-			uTimerLib();
-			void setInterval_us(void (*) (), unsigned long int);
-			void setInterval_s(void (*) (), unsigned long int);
-			void setTimeout_us(void (*) (), unsigned long int);
-			void setTimeout_s(void (*) (), unsigned long int);
-
-			/**
-			 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
-			 *
-			 * Note: This is device-dependant
-			 */
-			void clearTimer();
-
-			/**
-			 * \brief Internal intermediate function to control timer interrupts
-			 *
-			 * As timers doesn't give us enougth flexibility for large timings,
-			 * this function implements oferflow control to offer user desired timings.
-			 */
-			void _interrupt();
-
-			#ifdef _VARIANT_ARDUINO_STM32_
-				// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-				#ifdef BOARD_NAME
-					static callback_function_t interrupt();
-
-				// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-				#else
-					static void interrupt();
-				#endif
-			#endif
-
-			#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
-				#pragma message "ESP8266 / ESP32 can only reach a ms resolution so any us interrupt will be rounded to that"
-				static void interrupt();
-			#endif
-
-			#ifdef _SAMD21_
-				TcCount16* _TC = (TcCount16*) TC3;
-			#endif
-
-			#ifdef __SAMD51__
-				#pragma message "SAMD51 support is still experimental"
-			#endif
-
-		private:
-			static uTimerLib *_instance;
-
-			unsigned long int _overflows = 0;
-			unsigned long int __overflows = 0;
-			#ifdef ARDUINO_ARCH_AVR
-				unsigned char _remaining = 0;
-				unsigned char __remaining = 0;
-			#else
-				unsigned long int _remaining = 0;
-				unsigned long int __remaining = 0;
-			#endif
-			void (*_cb)() = NULL;
-			unsigned char _type = UTIMERLIB_TYPE_OFF;
-
-			void _loadRemaining();
-
-			void _attachInterrupt_us(unsigned long int);
-			void _attachInterrupt_s(unsigned long int);
-
-			#ifdef _VARIANT_ARDUINO_STM32_
-				bool _toInit = true;
-
-				// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
-				#ifdef BOARD_NAME
-					 HardwareTimer *Timer3 = new HardwareTimer(TIM3);
-
-				// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
-				#endif
-
-			#endif
-
-			#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
-				Ticker _ticker;
-			#endif
-	};
-
-	extern uTimerLib TimerLib;
-
-#endif
-
+/**
+ * \mainpage
+ * \brief Arduino tiny and cross-device compatible timer library.
+ *
+ * Timers used by each microcontroller:
+ *		* Atmel ATtiny X5:	Timer1 (2nd timer) - https://github.com/damellis/attiny and https://github.com/SpenceKonde/ATTinyCore (25, 45 and 85)
+ *		* Atmel AVR 32U4:	Timer3 (4rd timer)
+ *		* Atmel AVR other:	Timer2 (3rd timer)
+ *		* STM32:			Timer3 (3rd timer)
+ *		* SAM (Due):		TC3 (Timer1, channel 0)
+ *		* ESP8266:			OS Timer, one slot of seven available, shared by all uTimerLib objects (Software timer provided by Arduino because ESP8266 has only two hardware timers and one is needed by it normal operation)
+ *		* ESP32:			Hardware timer 0 (64 bit, 1us resolution)
+ *		* SAMD21:			TC3, CC0, 16 bits mode; TC4 (chained with TC5) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/40001882A.pdf
+ *		* SAMD51:			TC1, CC0, 16 bits mode; TC2 (chained with TC3) with UTIMERLIB_SAMD_COUNT32. See http://ww1.microchip.com/downloads/en/DeviceDoc/60001507C.pdf
+ *
+ * You have public TimerLib variable with following methods:
+ *		* TimerLib.setInterval_us(callback_function, microseconds);* : callback_function will be called each microseconds.
+ *		* TimerLib.setInterval_s(callback_function, seconds);* : callback_function will be called each seconds.
+ *		* TimerLib.setTimeout_us(callback_function, microseconds);* : callback_function will be called once when microseconds have passed.
+ *		* TimerLib.setTimeout_s(callback_function, seconds);* : callback_function will be called once when seconds have passed.
+ *		* TimerLib.setInterval_ms(callback_function, milliseconds);* and *TimerLib.setTimeout_ms(callback_function, milliseconds);* : same, in milliseconds, up to 49 days.
+ *		* TimerLib.setInterval_ticks(callback_function, ticks);* and *TimerLib.setTimeout_ticks(callback_function, ticks);* : same, in 64 bit count of UTIMERLIB_TICK_US ticks.
+ *		* TimerLib.setInterval_us(callback_function, context, microseconds);* , and same for all setXXX methods : callback_function(context) will be called; a uTimerLibDelegate can be passed instead, for member functions and lambdas.
+ *		* TimerLib.clearTimer();* : will clear any timed function if exists.
+ *		* TimerLib.clearTimer(handle);* : will clear only the timed function identified by handle, returned by setXXX methods.
+ *		* TimerLib.changePeriod_us(handle, microseconds);* : changes period of a running interval from next period on, without stopping timer; callable from interrupts.
+ *		* TimerLib.sleepUntilNext();* : sleeps until next timed function call, in deepest sleep mode compatible with running timer.
+ *		* TimerLib.now_ticks();* , *TimerLib.remaining_us();* and *TimerLib.getTickHz();* : timer counts since current period started, time until it ends and counts per second.
+ *		* TimerLib.setSlack_us(handle, microseconds);* : lets timed function run up to microseconds late, so it is grouped with others in one wake up, when UTIMERLIB_TICKLESS is defined.
+ *		* TimerLib.setInterval<1000_us>(callback_function);* and *TimerLib.setTimeout<20_ms>(callback_function);* : same, with a constant time calculated at compile time (C++11).
+ *		* TimerLib.dispatch();* : runs queued timed functions, when UTIMERLIB_DEFERRED is defined; with UTIMERLIB_RTOS a FreeRTOS task calls it (ESP32 / STM32).
+ *		* TimerLib.getStats();* and *TimerLib.resetStats();* : read and clear timer statistics, when UTIMERLIB_STATS is defined.
+ *		* TimerLib.setOverrunPolicy(policy);* and *TimerLib.getMissed();* : what to do with interval periods ending while timed function runs, and how many did, when UTIMERLIB_OVERRUN is defined.
+ *		* TimerLib.dumpTrace(Serial);* : prints last timer events (loops, remaining loads, calls, overruns) logged by timer interrupt, when UTIMERLIB_TRACE is defined.
+ *		* uTimerLib OtherTimer(timer);* : another object using hardware timer number timer, one of UTIMERLIB_TIMERS.
+ *		* TimerLib.setSampling_us(pin, buffer, length, callback_function, microseconds);* : samples analog pin to buffer by DMA, calling callback_function with each filled half, when UTIMERLIB_SAMPLING is defined (SAMD21 / SAMD51).
+ *		* TimerLib.setPulseTrain_us(callback_function, periods, count);* : calls callback_function after each of count successive periods, in microseconds, and stops; when UTIMERLIB_PULSE_TRAIN is defined.
+ *		* TimerLib.setSquareWave_us(pin, microseconds);* : outputs a square wave of microseconds period on pin, toggled by timer hardware when pin is timer output (AVR / ATtiny / STM32).
+ *		* TimerLib.setFrequency_hz(callback_function, hz);* : callback_function will be called hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz.
+ *		* TimerLib.setGroup_us(jobs, phases, count, period);* : calls each of count timed functions phases[i] microseconds after each shared period boundary, from one timer, when UTIMERLIB_GROUP is defined.
+ *
+ * Define UTIMERLIB_SLOTS greater than 1 to run up to UTIMERLIB_SLOTS timed functions at same time.
+ *
+ * @copyright Naguissa
+ * @author Naguissa
+ * @see <a href="https://github.com/Naguissa/uTimerLib">https://github.com/Naguissa/uTimerLib</a>
+ * @see <a href="https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html">https://www.foroelectro.net/librerias-arduino-ide-f29/utimerlib-libreria-arduino-para-eventos-temporizad-t191.html</a>
+ * @see <a href="mailto:naguissa@foroelectro.net">naguissa@foroelectro.net</a>
+ * @version 1.6.1
+ */
+/** \file uTimerLib.h
+ *   \brief uTimerLib header file
+ */
+#ifndef _uTimerLib_
+	/**
+	 * \brief Prevent multiple inclussion
+	 */
+	#define _uTimerLib_
+
+	#include "Arduino.h"
+	#include <string.h>
+
+	/*
+	 * UTIMERLIB_ESP8266_TIMER1: define it to use ESP8266 hardware Timer1 (FRC1) instead of OS timer, for times
+	 * below 1ms with 12.5ns resolution. Timer1 is also used by Servo, tone and analogWrite and there is only one,
+	 * so only one uTimerLib object can run on it.
+	 */
+
+	#if defined(ARDUINO_ARCH_ESP32) || (defined(ARDUINO_ARCH_ESP8266) && defined(UTIMERLIB_ESP8266_TIMER1))
+		/**
+		 * \brief Functions run from timer interrupt, kept on IRAM. On ESP8266 Timer1 they run while flash is busy; on ESP32 timer
+		 * calls of core they make are not on IRAM, so there they are not guaranteed to run while flash is busy
+		 */
+		#ifdef IRAM_ATTR
+			#define UTIMERLIB_ISR_ATTR IRAM_ATTR
+		#else
+			#define UTIMERLIB_ISR_ATTR ICACHE_RAM_ATTR
+		#endif
+	#else
+		#define UTIMERLIB_ISR_ATTR
+	#endif
+	// Operation modes
+	/**
+	 * \brief Internal status
+	 */
+	#define UTIMERLIB_TYPE_OFF 0
+	/**
+	 * \brief Internal status
+	 */
+	#define UTIMERLIB_TYPE_TIMEOUT 1
+	/**
+	 * \brief Internal status
+	 */
+	#define UTIMERLIB_TYPE_INTERVAL 2
+	/**
+	 * \brief Internal status
+	 */
+	#define UTIMERLIB_TYPE_SAMPLING 3
+	/**
+	 * \brief Internal status
+	 */
+	#define UTIMERLIB_TYPE_WAVE 4
+
+	#ifndef UTIMERLIB_SLOTS
+		/**
+		 * \brief Number of timed functions that can run at same time
+		 *
+		 * With 1 (default) any setXXX call replaces running timed function, using hardware timer directly.
+		 * Greater values enable a software scheduler that runs all slots from one hardware tick of UTIMERLIB_TICK_US.
+		 */
+		#define UTIMERLIB_SLOTS 1
+	#endif
+
+	#ifndef UTIMERLIB_TICK_US
+		/**
+		 * \brief Scheduler tick, in microseconds, when UTIMERLIB_SLOTS > 1. Must be a divisor of 1000000
+		 */
+		#define UTIMERLIB_TICK_US 1000
+	#endif
+
+	/*
+	 * UTIMERLIB_TICKLESS: define it, with UTIMERLIB_SLOTS > 1, to program hardware timer for nearest pending
+	 * timed function instead of running it each UTIMERLIB_TICK_US, so there are no wake ups between calls.
+	 * Deadlines are kept against micros(), so they do not drift with reprogramming. All slots due in same wake up, or less
+	 * than half a tick later, run together; setSlack_us() lets a slot wait for a later wake up to join it.
+	 */
+
+	/*
+	 * UTIMERLIB_STATS: define it to record timer statistics, read with TimerLib.getStats(): ISR count and entry latency,
+	 * callback duration and overruns (callbacks lasting a whole period or more). Times are CPU cycles, from DWT cycle counter
+	 * on Cortex-M3 and up (SAM, SAMD51, STM32), SysTick on SAMD21 and Cortex-M0/M0+ STM32, CPU cycle count on ESP and timer count register on AVR.
+	 */
+
+	/*
+	 * UTIMERLIB_DEFERRED: define it to run timed functions from TimerLib.dispatch(), called on loop() (or from a task on
+	 * ESP32 / STM32 FreeRTOS), instead of inside timer interrupt. Interrupt only queues them, so they can be slow or use Serial.
+	 */
+
+	/*
+	 * UTIMERLIB_RTOS: define it, on ESP32 and on STM32duino with STM32FreeRTOS, to run timed functions from a FreeRTOS task
+	 * on UTIMERLIB_DEFERRED mode, which it enables: interrupt queues calls and wakes up task with a direct task notification,
+	 * and task calls dispatch(), so they can use blocking APIs. Task is created by first setXXX call.
+	 */
+
+	#ifdef UTIMERLIB_RTOS
+		#if !defined(ARDUINO_ARCH_ESP32) && !((defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_STM32)) && defined(BOARD_NAME))
+			#error "UTIMERLIB_RTOS is only available on ESP32 and on ST's Arduino Core STM32"
+		#endif
+		#ifndef UTIMERLIB_DEFERRED
+			#define UTIMERLIB_DEFERRED
+		#endif
+		#ifdef BOARD_NAME
+			#include <STM32FreeRTOS.h>
+		#endif
+
+		#ifndef UTIMERLIB_RTOS_PRIORITY
+			/**
+			 * \brief Priority of timed functions task on UTIMERLIB_RTOS mode
+			 */
+			#define UTIMERLIB_RTOS_PRIORITY (configMAX_PRIORITIES - 1)
+		#endif
+
+		#ifndef UTIMERLIB_RTOS_STACK
+			/**
+			 * \brief Stack size of timed functions task on UTIMERLIB_RTOS mode, in bytes on ESP32 and in words on STM32
+			 */
+			#ifdef ARDUINO_ARCH_ESP32
+				#define UTIMERLIB_RTOS_STACK 4096
+			#else
+				#define UTIMERLIB_RTOS_STACK 256
+			#endif
+		#endif
+
+		#if defined(ARDUINO_ARCH_ESP32) && !defined(UTIMERLIB_RTOS_CORE)
+			/**
+			 * \brief ESP32 core timed functions task is pinned to; Arduino loop() one by default, so WiFi keeps the other one
+			 */
+			#ifdef ARDUINO_RUNNING_CORE
+				#define UTIMERLIB_RTOS_CORE ARDUINO_RUNNING_CORE
+			#else
+				#define UTIMERLIB_RTOS_CORE 1
+			#endif
+		#endif
+	#endif
+
+	/*
+	 * UTIMERLIB_LOW_POWER: define it to run setInterval_s() / setTimeout_s(), and other times over 4294 s, from a 32768Hz clock that keeps running in deep sleep,
+	 * so sleepUntilNext() can use it: asynchronous Timer2 with a crystal on TOSC1 / TOSC2 pins on AVR, and OSCULP32K / XOSC32K
+	 * through GCLK generator UTIMERLIB_LOW_POWER_GCLK on SAMD21 / SAMD51. Other times and devices keep their normal clock.
+	 */
+
+	#if defined(UTIMERLIB_LOW_POWER) && (defined(_SAMD21_) || defined(__SAMD51__)) && !defined(UTIMERLIB_LOW_POWER_GCLK)
+		/**
+		 * \brief GCLK generator used by UTIMERLIB_LOW_POWER; 5 on SAMD21, as 2 and 6 are used by RTCZero and ArduinoLowPower, and 6 on SAMD51
+		 */
+		#ifdef __SAMD51__
+			#define UTIMERLIB_LOW_POWER_GCLK 6
+		#else
+			#define UTIMERLIB_LOW_POWER_GCLK 5
+		#endif
+	#endif
+
+	/*
+	 * UTIMERLIB_SAMD_COUNT32: define it, on SAMD21 / SAMD51, to run TC as a 32 bit counter chained with next odd TC, which cannot be used then.
+	 * Times up to 89 s fit in one timer loop at full GCLK resolution, so there is one interrupt per period. Timers must be even ones:
+	 * TC4 (default) or TC6 on SAMD21, TC0, TC2 (default), TC4 or TC6 on SAMD51.
+	 */
+
+	#if defined(_SAMD21_) || defined(__SAMD51__)
+		/**
+		 * \brief TC counter width: 16 bit, or 32 bit on UTIMERLIB_SAMD_COUNT32 mode
+		 */
+		#ifdef UTIMERLIB_SAMD_COUNT32
+			#define UTIMERLIB_SAMD_BITS 32
+		#else
+			#define UTIMERLIB_SAMD_BITS 16
+		#endif
+	#endif
+
+	/*
+	 * UTIMERLIB_SAMPLING: define it, on SAMD21 / SAMD51, for setSampling_us(): timer starts ADC conversions through event system
+	 * and DMA stores results in a double buffer, so there is no interrupt per sample. It takes DMAC, so other DMA libraries cannot be used.
+	 */
+
+	/*
+	 * UTIMERLIB_PULSE_TRAIN: define it for setPulseTrain_us(): each period of a table, or given by a generator function, is loaded
+	 * by timer interrupt on previous period boundary, as changePeriod_us does, so there is no timer reconfiguration per pulse.
+	 * It needs UTIMERLIB_SLOTS 1.
+	 */
+
+	/*
+	 * UTIMERLIB_GROUP: define it for setGroup_us(): several timed functions sharing a period, each one at its own phase offset,
+	 * run by one timed function that steps through phases with changePeriod_us, so one timer and one interrupt per distinct phase
+	 * are used whatever group size is, and phases never drift apart.
+	 */
+
+	/*
+	 * UTIMERLIB_OVERRUN: define it to choose, with setOverrunPolicy(), what happens to interval periods ending while timed function
+	 * is still running, and to count them as missed ticks, read with getMissed(). Periods are measured with micros(), or DWT cycle
+	 * counter on Cortex-M3 and up (not on Cortex-M0/M0+ STM32); on AVR, where micros() stops inside interrupts, from timer
+	 * interrupt of period end being already pending when timed function returns. Interrupts are never enabled inside timer one.
+	 */
+
+	/*
+	 * UTIMERLIB_TRACE: define it to log timer interrupts in a static ring buffer of UTIMERLIB_TRACE_SIZE events, printed after
+	 * the fact with TimerLib.dumpTrace(Serial) out of interrupt context: micros() time stamp, hardware timer and event (intermediate
+	 * loop, remaining count load, timed function call or overrun). UTIMERLIB_TRACE_PIN, defined as a pin number, is driven high
+	 * during each timer interrupt, to be measured with a scope or logic analyzer; it can be used without UTIMERLIB_TRACE.
+	 * Without them nothing is compiled in.
+	 */
+
+	/*
+	 * Footprint profiles, for small devices as ATtiny85, with UTIMERLIB_SLOTS 1. Define one of each pair to strip unused code and state:
+	 *  - UTIMERLIB_INTERVAL_ONLY: only setInterval_xxx. UTIMERLIB_TIMEOUT_ONLY: only setTimeout_xxx, without changePeriod_us and its reload values.
+	 *  - UTIMERLIB_US_ONLY: only xxx_us times, without 64 bit times, so ATtiny loop counters are 16 bit. UTIMERLIB_S_ONLY: only xxx_s times.
+	 * setInterval<> and setTimeout<> follow same selection. README lists RAM used by each profile.
+	 */
+
+	#if defined(UTIMERLIB_SAMPLING) && (defined(_SAMD21_) || defined(__SAMD51__))
+		#ifndef UTIMERLIB_DMA_CHANNEL
+			/**
+			 * \brief DMA channel used on UTIMERLIB_SAMPLING mode; 0 to 3 on SAMD51
+			 */
+			#define UTIMERLIB_DMA_CHANNEL 0
+		#endif
+
+		#ifndef UTIMERLIB_EVSYS_CHANNEL
+			/**
+			 * \brief Event system channel used on UTIMERLIB_SAMPLING mode to start ADC from timer
+			 */
+			#define UTIMERLIB_EVSYS_CHANNEL 0
+		#endif
+	#endif
+
+	#ifndef UTIMERLIB_QUEUE_SIZE
+		/**
+		 * \brief Pending calls queue size on UTIMERLIB_DEFERRED mode. Must be a power of 2, up to 128
+		 */
+		#define UTIMERLIB_QUEUE_SIZE 8
+	#endif
+
+	#ifndef UTIMERLIB_OVERRUN_BURST
+		/**
+		 * \brief Most missed calls run back to back after a timed function on UTIMERLIB_OVERRUN_CATCHUP policy
+		 */
+		#define UTIMERLIB_OVERRUN_BURST 4
+	#endif
+
+	#ifndef UTIMERLIB_TRACE_SIZE
+		/**
+		 * \brief Events kept on UTIMERLIB_TRACE mode, older ones being overwritten. Must be a power of 2
+		 */
+		#define UTIMERLIB_TRACE_SIZE 32
+	#endif
+
+	#ifndef UTIMERLIB_TICKLESS_MAX_US
+		/**
+		 * \brief Longest wait, in microseconds, programmed at once on tickless mode
+		 *
+		 * Longer waits are split, so they are safe for every device timer and for micros() overflow.
+		 */
+		#define UTIMERLIB_TICKLESS_MAX_US 8000000
+	#endif
+
+	#if defined(__SAMD51__) && !defined(UTIMERLIB_SAMD51_GCLK_HZ)
+		/**
+		 * \brief Frequency of GCLK1, used as SAMD51 timer clock; 48MHz on Arduino and Adafruit cores
+		 */
+		#define UTIMERLIB_SAMD51_GCLK_HZ 48000000UL
+	#endif
+
+	#if UTIMERLIB_SLOTS < 1 || UTIMERLIB_SLOTS > 255
+		#error "UTIMERLIB_SLOTS must be between 1 and 255"
+	#endif
+
+	#if (1000000UL % UTIMERLIB_TICK_US) != 0
+		#error "UTIMERLIB_TICK_US must be a divisor of 1000000"
+	#endif
+
+	#if UTIMERLIB_QUEUE_SIZE < 2 || UTIMERLIB_QUEUE_SIZE > 128 || (UTIMERLIB_QUEUE_SIZE & (UTIMERLIB_QUEUE_SIZE - 1)) != 0
+		#error "UTIMERLIB_QUEUE_SIZE must be a power of 2, from 2 to 128"
+	#endif
+
+	#if UTIMERLIB_TRACE_SIZE < 2 || (UTIMERLIB_TRACE_SIZE & (UTIMERLIB_TRACE_SIZE - 1)) != 0
+		#error "UTIMERLIB_TRACE_SIZE must be a power of 2"
+	#endif
+
+	#if defined(UTIMERLIB_TICKLESS) && UTIMERLIB_SLOTS < 2
+		#error "UTIMERLIB_TICKLESS needs UTIMERLIB_SLOTS greater than 1"
+	#endif
+
+	#if defined(UTIMERLIB_PULSE_TRAIN) && UTIMERLIB_SLOTS > 1
+		#error "UTIMERLIB_PULSE_TRAIN needs UTIMERLIB_SLOTS 1"
+	#endif
+
+	#if (defined(UTIMERLIB_INTERVAL_ONLY) && defined(UTIMERLIB_TIMEOUT_ONLY)) || (defined(UTIMERLIB_US_ONLY) && defined(UTIMERLIB_S_ONLY))
+		#error "Only one of UTIMERLIB_INTERVAL_ONLY and UTIMERLIB_TIMEOUT_ONLY, and one of UTIMERLIB_US_ONLY and UTIMERLIB_S_ONLY, can be defined"
+	#endif
+
+	#if (defined(UTIMERLIB_INTERVAL_ONLY) || defined(UTIMERLIB_TIMEOUT_ONLY) || defined(UTIMERLIB_US_ONLY) || defined(UTIMERLIB_S_ONLY)) && UTIMERLIB_SLOTS > 1
+		#error "UTIMERLIB_xxx_ONLY profiles need UTIMERLIB_SLOTS 1"
+	#endif
+
+	#if defined(UTIMERLIB_TIMEOUT_ONLY) && defined(UTIMERLIB_PULSE_TRAIN)
+		#error "UTIMERLIB_PULSE_TRAIN cannot be used with UTIMERLIB_TIMEOUT_ONLY"
+	#endif
+
+	#if defined(UTIMERLIB_GROUP) && (defined(UTIMERLIB_TIMEOUT_ONLY) || defined(UTIMERLIB_S_ONLY))
+		#error "UTIMERLIB_GROUP cannot be used with UTIMERLIB_TIMEOUT_ONLY nor UTIMERLIB_S_ONLY"
+	#endif
+
+	#if defined(UTIMERLIB_OVERRUN) && (defined(UTIMERLIB_TIMEOUT_ONLY) || defined(UTIMERLIB_TICKLESS))
+		#error "UTIMERLIB_OVERRUN cannot be used with UTIMERLIB_TIMEOUT_ONLY nor UTIMERLIB_TICKLESS, as there are no interval timer periods"
+	#endif
+
+	#if UTIMERLIB_SLOTS == 1 && !defined(UTIMERLIB_TIMEOUT_ONLY)
+		/**
+		 * \brief Running interval period can be changed (changePeriod_us), so reload values are kept for timer interrupt
+		 */
+		#define UTIMERLIB_RELOAD
+	#endif
+
+	#if UTIMERLIB_SLOTS == 1 && !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && (defined(ARDUINO_ARCH_AVR) || (defined(_VARIANT_ARDUINO_STM32_) && defined(BOARD_NAME)))
+		/**
+		 * \brief Timer can toggle its output pin by itself, so setSquareWave_us needs no interrupt on that pin
+		 */
+		#define UTIMERLIB_HW_WAVE
+	#endif
+
+	/**
+	 * \brief Overrun policy, default: a period ending while timed function runs gives one late call when it returns, as timer
+	 * interrupt is pending; following ones are lost
+	 */
+	#define UTIMERLIB_OVERRUN_CONTINUE 0
+
+	/**
+	 * \brief Overrun policy: periods ending while timed function runs give no call, so next call is on next period boundary
+	 */
+	#define UTIMERLIB_OVERRUN_SKIP 1
+
+	/**
+	 * \brief Overrun policy: periods ending while timed function runs are called back to back when it returns, up to UTIMERLIB_OVERRUN_BURST
+	 */
+	#define UTIMERLIB_OVERRUN_CATCHUP 2
+
+	/**
+	 * \brief Trace event: timer interrupt of an intermediate loop of a long period
+	 */
+	#define UTIMERLIB_TRACE_OVERFLOW 1
+
+	/**
+	 * \brief Trace event: timer interrupt loading remaining counts of a long period
+	 */
+	#define UTIMERLIB_TRACE_REMAINING 2
+
+	/**
+	 * \brief Trace event: timed function called, or queued on UTIMERLIB_DEFERRED mode
+	 */
+	#define UTIMERLIB_TRACE_FIRE 3
+
+	/**
+	 * \brief Trace event: timed function lasted a whole period or more, so periods were missed
+	 */
+	#define UTIMERLIB_TRACE_OVERRUN 4
+
+	/**
+	 * \brief Invalid timer handle, returned when timed function cannot be scheduled
+	 */
+	#define UTIMERLIB_INVALID_HANDLE 0
+
+	/**
+	 * \brief Timer handle, returned by setXXX functions and used to cancel a timed function
+	 *
+	 * Low byte is slot number + 1, high byte is slot generation, so an old handle never cancels a reused slot.
+	 */
+	typedef uint16_t uTimerLibHandle;
+
+	/**
+	 * \brief Timed function: a function receiving a context pointer, plus that pointer. Two words, copied by value, never allocates
+	 *
+	 * Implicitly built from a plain void function or from a function and its context. member<T, &T::method>(&object) calls a
+	 * member function, bind(lambda) stores a small function object (trivially copyable, up to pointer size, as [this] or [&var]
+	 * lambdas) inline, and ref(object) calls any function object, which caller must keep alive while timed function runs.
+	 */
+	class uTimerLibDelegate {
+		public:
+			uTimerLibDelegate() : _fn(NULL), _ctx(NULL) {}
+			uTimerLibDelegate(void (* fn)(void *), void * ctx) : _fn(fn), _ctx(ctx) {}
+			uTimerLibDelegate(void (* fn)()) : _fn(fn ? _plain : NULL), _ctx(NULL) {
+				// Function pointer is stored on context, so no other field is needed
+				memcpy(&_ctx, &fn, sizeof(fn));
+			}
+
+			template <class T, void (T::* M)()> static uTimerLibDelegate member(T * obj) {
+				return uTimerLibDelegate(_member<T, M>, obj);
+			}
+
+			template <class F> static uTimerLibDelegate ref(F & f) {
+				return uTimerLibDelegate(_ref<F>, &f);
+			}
+
+			#if __cplusplus >= 201103L
+				template <class F> static uTimerLibDelegate bind(const F & f) {
+					static_assert(sizeof(F) <= sizeof(void *), "uTimerLib: function object too big for bind(), use ref()");
+					static_assert(__has_trivial_copy(F) && __has_trivial_destructor(F), "uTimerLib: bind() needs a trivially copyable function object, use ref()");
+					uTimerLibDelegate d(_bound<F>, NULL);
+					memcpy(&d._ctx, &f, sizeof(F));
+					return d;
+				}
+			#endif
+
+			inline void operator()() const {
+				_fn(_ctx);
+			}
+
+			inline bool operator==(const uTimerLibDelegate & other) const {
+				return _fn == other._fn && _ctx == other._ctx;
+			}
+
+			void (* _fn)(void *);
+			void * _ctx;
+
+		private:
+			static void UTIMERLIB_ISR_ATTR _plain(void * ctx) {
+				void (* fn)();
+				memcpy(&fn, &ctx, sizeof(fn));
+				fn();
+			}
+
+			template <class T, void (T::* M)()> static void UTIMERLIB_ISR_ATTR _member(void * obj) {
+				(static_cast<T *>(obj)->*M)();
+			}
+
+			template <class F> static void UTIMERLIB_ISR_ATTR _ref(void * f) {
+				(*static_cast<F *>(f))();
+			}
+
+			#if __cplusplus >= 201103L
+				template <class F> static void UTIMERLIB_ISR_ATTR _bound(void * ctx) {
+					alignas(F) unsigned char f[sizeof(F)];
+					memcpy(f, &ctx, sizeof(F));
+					(*reinterpret_cast<F *>(f))();
+				}
+			#endif
+	};
+
+	#ifdef UTIMERLIB_STATS
+		/**
+		 * \brief Timer statistics, returned by getStats() when UTIMERLIB_STATS is defined. Times are in CPU cycles
+		 *
+		 * With UTIMERLIB_SLOTS > 1 callback times are for whole scheduler tick, with all due timed functions.
+		 */
+		struct uTimerLibStats {
+			unsigned long int isrCount;		// Timer interrupts, including intermediate loops of long times
+			unsigned long int latencyMin;	// ISR entry latency, from timer count at entry; 0 where not available (ESP8266, SAMD51)
+			unsigned long int latencyMax;
+			unsigned long int callbacks;	// Callback calls
+			unsigned long int callbackMin;
+			unsigned long int callbackMax;
+			unsigned long int callbackMean;
+			unsigned long int overruns;		// Callbacks lasting a whole period or more, so at least one tick was missed
+		};
+	#endif
+
+	#ifdef UTIMERLIB_TRACE
+		/**
+		 * \brief Trace event, logged by timer interrupt on UTIMERLIB_TRACE mode
+		 */
+		struct uTimerLibTraceEvent {
+			unsigned long int us;	// micros() when logged
+			unsigned char timer;	// Hardware timer number, 0 where there is only one
+			unsigned char kind;		// One of UTIMERLIB_TRACE_xxx
+		};
+	#endif
+
+	// Hardware implementation families, same selection than uTimerLib.cpp
+	#if (defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_AVR)) && !defined(ARDUINO_attiny) && !defined(ARDUINO_AVR_ATTINYX4) && !defined(ARDUINO_AVR_ATTINYX5) && !defined(ARDUINO_AVR_ATTINYX7) && !defined(ARDUINO_AVR_ATTINYX8) && !defined(ARDUINO_AVR_ATTINYX61) && !defined(ARDUINO_AVR_ATTINY43) && !defined(ARDUINO_AVR_ATTINY828) && !defined(ARDUINO_AVR_ATTINY1634) && !defined(ARDUINO_AVR_ATTINYX313)
+		/**
+		 * \brief AVR implementation (Timer2 or 16 bit Timer1, 3, 4 and 5) is used
+		 */
+		#define UTIMERLIB_HW_AVR
+	#endif
+
+	#ifndef UTIMERLIB_TIMER
+		/**
+		 * \brief Hardware timer used by TimerLib; more uTimerLib instances can be created for other ones
+		 *
+		 * AVR: 2 (Timer2, default) or 16 bit Timer1, 3 (default on 32U4), 4 and 5; SAM: TC0 to TC8 (3 by default);
+		 * SAMD21: TC3 (default; TC4 with UTIMERLIB_SAMD_COUNT32) to TC7; SAMD51: TC0 to TC7 (1 by default; 2 with UTIMERLIB_SAMD_COUNT32); STM32: TIM1 to TIM17 (Timer1 to Timer4 on Roger Clark core; 3 by default);
+		 * ESP32: 0 (default) to 3. ATtiny (Timer1) and ESP8266 (one OS timer shared by all instances, or Timer1) ignore it.
+		 */
+		#if defined(UTIMERLIB_SAMD_COUNT32) && defined(_SAMD21_)
+			#define UTIMERLIB_TIMER 4
+		#elif defined(UTIMERLIB_SAMD_COUNT32) && defined(__SAMD51__)
+			#define UTIMERLIB_TIMER 2
+		#elif defined(__AVR_ATmega32U4__) || defined(ARDUINO_ARCH_SAM) || defined(_SAMD21_) || defined(_VARIANT_ARDUINO_STM32_)
+			#define UTIMERLIB_TIMER 3
+		#elif defined(__SAMD51__)
+			#define UTIMERLIB_TIMER 1
+		#elif defined(UTIMERLIB_HW_AVR)
+			#define UTIMERLIB_TIMER 2
+		#else
+			#define UTIMERLIB_TIMER 0
+		#endif
+	#endif
+
+	#if defined(UTIMERLIB_HW_AVR) || defined(ARDUINO_ARCH_SAM) || defined(_SAMD21_) || defined(__SAMD51__) || defined(_VARIANT_ARDUINO_STM32_) || defined(ARDUINO_ARCH_ESP32)
+		/**
+		 * \brief Implementation can use several hardware timers, selected by number
+		 */
+		#define UTIMERLIB_HW_TIMERS
+
+		#ifndef UTIMERLIB_TIMERS
+			/**
+			 * \brief Hardware timers that uTimerLib instances can use, bit n for timer n. uTimerLib defines their interrupt handlers
+			 */
+			#define UTIMERLIB_TIMERS (1UL << UTIMERLIB_TIMER)
+		#endif
+
+		#if (UTIMERLIB_TIMERS & (1UL << UTIMERLIB_TIMER)) == 0
+			#error "UTIMERLIB_TIMERS must include UTIMERLIB_TIMER"
+		#endif
+
+		/**
+		 * \brief Position of hardware timer n in uTimerLib::_instances
+		 */
+		#define UTIMERLIB_TIMER_INDEX(n) __builtin_popcountl(UTIMERLIB_TIMERS & ((1UL << (n)) - 1))
+	#endif
+
+	#ifdef _VARIANT_ARDUINO_STM32_
+		#include "HardwareTimer.h"
+
+		// ST's Arduino Core STM32, https://github.com/stm32duino/Arduino_Core_STM32
+		#ifdef BOARD_NAME
+			// Private member, created for selected timer
+
+		// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32
+		#else
+			extern HardwareTimer Timer1;
+			extern HardwareTimer Timer2;
+			extern HardwareTimer Timer3;
+			extern HardwareTimer Timer4;
+		#endif
+	#endif
+
+	class uTimerLib {
+		public:
+			explicit uTimerLib(unsigned char = UTIMERLIB_TIMER);
+
+			// Each one also for plain functions and for functions receiving a context pointer; footprint profiles remove unused ones
+			#ifndef UTIMERLIB_TIMEOUT_ONLY
+				#ifndef UTIMERLIB_S_ONLY
+					uTimerLibHandle setInterval_us(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setInterval_us(void (* cb)(), unsigned long int time) { return setInterval_us(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setInterval_us(void (* cb)(void *), void * ctx, unsigned long int time) { return setInterval_us(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+				#ifndef UTIMERLIB_US_ONLY
+					uTimerLibHandle setInterval_s(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setInterval_s(void (* cb)(), unsigned long int time) { return setInterval_s(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setInterval_s(void (* cb)(void *), void * ctx, unsigned long int time) { return setInterval_s(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+				#if !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+					uTimerLibHandle setInterval_ms(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setInterval_ms(void (* cb)(), unsigned long int time) { return setInterval_ms(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setInterval_ms(void (* cb)(void *), void * ctx, unsigned long int time) { return setInterval_ms(uTimerLibDelegate(cb, ctx), time); }
+					uTimerLibHandle setInterval_ticks(uTimerLibDelegate, unsigned long long);
+					inline uTimerLibHandle setInterval_ticks(void (* cb)(), unsigned long long time) { return setInterval_ticks(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setInterval_ticks(void (* cb)(void *), void * ctx, unsigned long long time) { return setInterval_ticks(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+			#endif
+			#ifndef UTIMERLIB_INTERVAL_ONLY
+				#ifndef UTIMERLIB_S_ONLY
+					uTimerLibHandle setTimeout_us(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setTimeout_us(void (* cb)(), unsigned long int time) { return setTimeout_us(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setTimeout_us(void (* cb)(void *), void * ctx, unsigned long int time) { return setTimeout_us(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+				#ifndef UTIMERLIB_US_ONLY
+					uTimerLibHandle setTimeout_s(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setTimeout_s(void (* cb)(), unsigned long int time) { return setTimeout_s(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setTimeout_s(void (* cb)(void *), void * ctx, unsigned long int time) { return setTimeout_s(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+				#if !defined(UTIMERLIB_US_ONLY) && !defined(UTIMERLIB_S_ONLY)
+					uTimerLibHandle setTimeout_ms(uTimerLibDelegate, unsigned long int);
+					inline uTimerLibHandle setTimeout_ms(void (* cb)(), unsigned long int time) { return setTimeout_ms(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setTimeout_ms(void (* cb)(void *), void * ctx, unsigned long int time) { return setTimeout_ms(uTimerLibDelegate(cb, ctx), time); }
+					uTimerLibHandle setTimeout_ticks(uTimerLibDelegate, unsigned long long);
+					inline uTimerLibHandle setTimeout_ticks(void (* cb)(), unsigned long long time) { return setTimeout_ticks(uTimerLibDelegate(cb), time); }
+					inline uTimerLibHandle setTimeout_ticks(void (* cb)(void *), void * ctx, unsigned long long time) { return setTimeout_ticks(uTimerLibDelegate(cb, ctx), time); }
+				#endif
+			#endif
+
+			/**
+			 * \brief Cancels one timed function, given its handle
+			 */
+			void clearTimer(uTimerLibHandle);
+
+			#ifndef UTIMERLIB_TIMEOUT_ONLY
+				/**
+				 * \brief Changes period of a running interval from next period on, without stopping timer nor disabling interrupts
+				 */
+				bool changePeriod_us(uTimerLibHandle, unsigned long int);
+			#endif
+
+			#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY)
+				/**
+				 * \brief Square wave of us microseconds period on pin, toggled by timer hardware when pin is its output, or by interrupt
+				 */
+				uTimerLibHandle setSquareWave_us(unsigned char, unsigned long int);
+
+				/**
+				 * \brief Interval at hz times per second, timer counts fitted to clock / hz; returns achieved frequency in mHz, 0 on error
+				 */
+				unsigned long int setFrequency_hz(uTimerLibDelegate, unsigned long int, uTimerLibHandle * = NULL);
+				inline unsigned long int setFrequency_hz(void (* cb)(), unsigned long int hz, uTimerLibHandle * handle = NULL) { return setFrequency_hz(uTimerLibDelegate(cb), hz, handle); }
+				inline unsigned long int setFrequency_hz(void (* cb)(void *), void * ctx, unsigned long int hz, uTimerLibHandle * handle = NULL) { return setFrequency_hz(uTimerLibDelegate(cb, ctx), hz, handle); }
+			#endif
+
+			/**
+			 * \brief Sleeps until next timed function call, in deepest sleep mode that keeps running timer
+			 *
+			 * Note: This is device-dependant
+			 */
+			void sleepUntilNext();
+
+			/**
+			 * \brief Timer counts since current period started, at getTickHz() counts per second; consistent with interrupt
+			 *
+			 * Note: This is device-dependant
+			 */
+			unsigned long long now_ticks();
+			unsigned long int remaining_us();
+			unsigned long int getTickHz();
+
+			#ifdef UTIMERLIB_TICKLESS
+				bool setSlack_us(uTimerLibHandle, unsigned long int);
+			#endif
+
+			#ifdef UTIMERLIB_DEFERRED
+				unsigned char dispatch();
+				unsigned long int getCoalesced();
+			#endif
+
+			#ifdef UTIMERLIB_STATS
+				uTimerLibStats getStats();
+				void resetStats();
+			#endif
+
+			#ifdef UTIMERLIB_OVERRUN
+				void setOverrunPolicy(unsigned char);
+				unsigned long int getMissed();
+			#endif
+
+			#ifdef UTIMERLIB_TRACE
+				void dumpTrace(Stream &);
+			#endif
+
+			#ifdef UTIMERLIB_GROUP
+				uTimerLibHandle setGroup_us(const uTimerLibDelegate *, const unsigned long int *, unsigned char, unsigned long int);
+			#endif
+
+			#ifdef UTIMERLIB_PULSE_TRAIN
+				uTimerLibHandle setPulseTrain_us(uTimerLibDelegate, const unsigned long int *, unsigned int);
+				uTimerLibHandle setPulseTrain_us(uTimerLibDelegate, unsigned long int (*)(void *), void *);
+				inline uTimerLibHandle setPulseTrain_us(void (* cb)(), const unsigned long int * periods, unsigned int count) { return setPulseTrain_us(uTimerLibDelegate(cb), periods, count); }
+				inline uTimerLibHandle setPulseTrain_us(void (* cb)(), unsigned long int (* next)(void *), void * ctx) { return setPulseTrain_us(uTimerLibDelegate(cb), next, ctx); }
+			#endif
+
+			#if defined(UTIMERLIB_SAMPLING) && (defined(_SAMD21_) || defined(__SAMD51__))
+				bool setSampling_us(unsigned char, uint16_t *, unsigned int, void (*) (uint16_t *, unsigned int), unsigned long int);
+				void _dmaInterrupt();
+			#endif
+
+			#if __cplusplus >= 201103L
+				#ifndef UTIMERLIB_TIMEOUT_ONLY
+					/**
+					 * \brief Attaches a callback function to be executed each US microseconds, being US a constant as 1000_us, 20_ms or 5_s
+					 *
+					 * On AVR and SAMD21 timer values are calculated at compile time, so only timer registers are set at run time.
+					 */
+					template <unsigned long long US> uTimerLibHandle setInterval(uTimerLibDelegate cb) {
+						return _setConst<US>(cb, UTIMERLIB_TYPE_INTERVAL);
+					}
+					template <unsigned long long US> uTimerLibHandle setInterval(void (* cb)()) {
+						return _setConst<US>(uTimerLibDelegate(cb), UTIMERLIB_TYPE_INTERVAL);
+					}
+					template <unsigned long long US> uTimerLibHandle setInterval(void (* cb)(void *), void * ctx) {
+						return _setConst<US>(uTimerLibDelegate(cb, ctx), UTIMERLIB_TYPE_INTERVAL);
+					}
+				#endif
+				#ifndef UTIMERLIB_INTERVAL_ONLY
+					/**
+					 * \brief Attaches a callback function to be executed once when US microseconds have passed, being US a constant as 1000_us, 20_ms or 5_s
+					 *
+					 * On AVR and SAMD21 timer values are calculated at compile time, so only timer registers are set at run time.
+					 */
+					template <unsigned long long US> uTimerLibHandle setTimeout(uTimerLibDelegate cb) {
+						return _setConst<US>(cb, UTIMERLIB_TYPE_TIMEOUT);
+					}
+					template <unsigned long long US> uTimerLibHandle setTimeout(void (* cb)()) {
+						return _setConst<US>(uTimerLibDelegate(cb), UTIMERLIB_TYPE_TIMEOUT);
+					}
+					template <unsigned long long US> uTimerLibHandle setTimeout(void (* cb)(void *), void * ctx) {
+						return _setConst<US>(uTimerLibDelegate(cb, ctx), UTIMERLIB_TYPE_TIMEOUT);
+					}
+				#endif
+			#endif
+
+			/**
+			 * \brief Loads last bit of time needed to precisely count until desired time (non complete loop)
+			 *
+			 * Note: This is device-dependant
+			 */
+			void clearTimer();
+
+			/**
+			 * \brief Internal intermediate function to control timer interrupts
+			 *
+			 * As timers doesn't give us enougth flexibility for large timings,
+			 * this function implements oferflow control to offer user desired timings.
+			 */
+			void _interrupt();
+
+			#if (defined(_VARIANT_ARDUINO_STM32_) && !defined(BOARD_NAME)) || defined(ARDUINO_ARCH_ESP32)
+				// Roger Clark Arduino STM32, https://github.com/rogerclarkmelbourne/Arduino_STM32, and ESP32: interrupt handler for timer N
+				template <unsigned char N> static void UTIMERLIB_ISR_ATTR interrupt() {
+					_instances[UTIMERLIB_TIMER_INDEX(N)]->_interrupt();
+				}
+			#endif
+
+			#if defined(ARDUINO_ARCH_ESP8266) && !defined(UTIMERLIB_ESP8266_TIMER1)
+				#pragma message "ESP8266 OS timer can only reach a ms resolution so any us interrupt can be up to 1ms late; define UTIMERLIB_ESP8266_TIMER1 for us"
+			#endif
+
+			#ifdef UTIMERLIB_HW_TIMERS
+				// Instance using each hardware timer of UTIMERLIB_TIMERS, for interrupt handlers
+				static uTimerLib * _instances[__builtin_popcountl(UTIMERLIB_TIMERS)];
+			#endif
+
+			#if defined(_SAMD21_) || defined(__SAMD51__)
+				TcCount16* _TC;
+			#endif
+
+			#ifdef __SAMD51__
+				#pragma message "SAMD51 support is still experimental"
+			#endif
+
+		private:
+			#if defined(UTIMERLIB_SAMPLING) && (defined(_SAMD21_) || defined(__SAMD51__))
+				// Sampling double buffer: DMA fills one half while the other one is passed to _dmaCb
+				uint16_t * _dmaBuffer = NULL;
+				unsigned int _dmaHalf = 0;
+				volatile unsigned char _dmaNext = 0;
+				void (* _dmaCb)(uint16_t *, unsigned int) = NULL;
+				void _stopSampling();
+			#endif
+
+			#ifdef UTIMERLIB_HW_TIMERS
+				unsigned char _timer;
+				void _setTimer(unsigned char);
+			#endif
+
+			// Timer loops and partial loop counts, in smallest types fitting device timer
+			#if defined(ARDUINO_ARCH_AVR) && !defined(UTIMERLIB_HW_AVR) && defined(UTIMERLIB_US_ONLY)
+				// ATtiny: up to 2^32 us at prescaler 16384 are less than 65536 loops of 256 counts, for F_CPU up to 64MHz
+				typedef unsigned int _loops_t;
+			#else
+				typedef unsigned long int _loops_t;
+			#endif
+			#if defined(UTIMERLIB_HW_AVR)
+				typedef unsigned int _counts_t;
+			#elif defined(ARDUINO_ARCH_AVR)
+				typedef unsigned char _counts_t;
+			#else
+				typedef unsigned long int _counts_t;
+			#endif
+			_loops_t _overflows = 0;
+			_loops_t __overflows = 0;
+			_counts_t _remaining = 0;
+			_counts_t __remaining = 0;
+			uTimerLibDelegate _cb;
+			unsigned char _type = UTIMERLIB_TYPE_OFF;
+			unsigned char _gen = 0;
+			// Timer interrupt calls, so sleepUntilNext() knows when one has happened
+			volatile unsigned char _calls = 0;
+			#if defined(UTIMERLIB_LOW_POWER) && (defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__))
+				// Next _attachInterrupt_raw uses 32768Hz clock; set by _attachInterrupt_long
+				bool _slowClock = false;
+			#endif
+			#if defined(_SAMD21_) || defined(__SAMD51__)
+				// GCLK generator feeding TC, so peripheral clock is only configured on first use and when it changes
+				unsigned char _clockGen = 0xFF;
+				// CC0 loaded on TC, so interrupt does not write same TOP again
+				unsigned long int _loadedTop = 0;
+			#endif
+
+			#if UTIMERLIB_SLOTS > 1
+				/**
+				 * \brief Scheduler slot: one timed function counted in UTIMERLIB_TICK_US ticks
+				 */
+				struct _slot_t {
+					uTimerLibDelegate cb;
+					volatile unsigned long int period;
+					volatile long int count;
+					volatile unsigned char type;
+					volatile unsigned char gen;
+					// Period set by changePeriod_us, loaded on next reload when nextReady is set
+					volatile unsigned long int next;
+					volatile bool nextReady;
+					#ifdef UTIMERLIB_TICKLESS
+						volatile unsigned long int slack;
+					#endif
+				};
+				_slot_t _slots[UTIMERLIB_SLOTS] = {};
+
+				unsigned long long _usToTicks(unsigned long long);
+				uTimerLibHandle _addSlot(uTimerLibDelegate, unsigned char, unsigned long long);
+				void _tick();
+
+				#ifdef UTIMERLIB_TICKLESS
+					unsigned long int _base = 0;
+					volatile bool _inTick = false;
+
+					void _advance();
+					long int _nextWait();
+					void _arm(unsigned long int);
+				#endif
+			#else
+				uTimerLibHandle _newHandle(unsigned long int);
+			#endif
+
+			#ifdef UTIMERLIB_RELOAD
+				// Reload values set by changePeriod_us, device-dependant, loaded by interrupt on next period boundary when _nextReady is set
+				volatile bool _nextReady = false;
+				_loops_t _nextOverflows = 0;
+				_counts_t _nextRemaining = 0;
+				#if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+					unsigned long int _nextLongLoops = 0;
+				#endif
+				unsigned long int _nextFracNum = 0;
+				unsigned long int _nextFracDen = 1;
+				#ifdef ARDUINO_ARCH_AVR
+					unsigned char _nextPrescaler = 0; // CS bits
+				#else
+					unsigned long int _nextPrescaler = 0;
+				#endif
+
+				#ifdef UTIMERLIB_PULSE_TRAIN
+					// Pulse train source, a table or a generator, and whether last period is already loaded
+					const unsigned long int * _trainTable = NULL;
+					unsigned int _trainCount = 0;
+					volatile unsigned int _trainIndex = 0;
+					unsigned long int (* volatile _trainFn)(void *) = NULL;
+					void * _trainCtx = NULL;
+					volatile bool _trainStop = false;
+					volatile bool _train = false;
+
+					unsigned long int _trainNext();
+					uTimerLibHandle _startTrain(uTimerLibDelegate);
+					void _trainStep();
+				#endif
+
+				bool _changePeriod_us(unsigned long int);
+				void _setNext(unsigned long int, unsigned long int, unsigned long int, unsigned long int, unsigned long int, unsigned long int);
+				void _takeNext();
+				void _loadNext();
+			#endif
+
+			#ifdef UTIMERLIB_GROUP
+				// Group of setGroup_us: tables given by caller, next job to call and step period already published
+				const uTimerLibDelegate * _groupJobs = NULL;
+				const unsigned long int * _groupPhases = NULL;
+				unsigned char _groupCount = 0;
+				volatile unsigned char _groupIndex = 0;
+				unsigned long int _groupPeriod = 0;
+				unsigned long int _groupLoaded = 0;
+				uTimerLibHandle _groupHandle = UTIMERLIB_INVALID_HANDLE;
+
+				unsigned long int _groupGap(unsigned char);
+				static void _groupFire(void *);
+			#endif
+
+			void _loadRemaining();
+			void _callback();
+			void _run(const uTimerLibDelegate &);
+			void _fire();
+
+			#ifdef UTIMERLIB_DEFERRED
+				// Pending calls, single producer (timer interrupt) and single consumer (dispatch) ring buffer
+				// Calls are stored as function and context arrays, so each field is written before publishing it
+				void (* volatile _queueFn[UTIMERLIB_QUEUE_SIZE])(void *) = {};
+				void * volatile _queueCtx[UTIMERLIB_QUEUE_SIZE] = {};
+				volatile unsigned char _queueHead = 0;
+				volatile unsigned char _queueTail = 0;
+				volatile unsigned long int _coalesced = 0;
+
+				#ifdef UTIMERLIB_RTOS
+					// Task running dispatch(), woken up by timer interrupt
+					TaskHandle_t _rtosTask = NULL;
+					void _rtosStart();
+					void _rtosNotify();
+					static void _rtosLoop(void *);
+				#endif
+			#endif
+
+			#ifdef UTIMERLIB_STATS
+				uTimerLibStats _stats = {0, 0xFFFFFFFF, 0, 0, 0xFFFFFFFF, 0, 0, 0};
+				unsigned long long _statsTotal = 0;
+				// Programmed period, in CPU cycles, to detect overruns
+				unsigned long int _statsPeriod = 0xFFFFFFFF;
+
+				void _statsSetup(unsigned long long);
+				void _statsIsr(unsigned long int);
+				unsigned long int _statsLatency();
+				unsigned long int _statsCycles();
+				unsigned long int _statsElapsed(unsigned long int);
+			#endif
+
+			#ifdef UTIMERLIB_OVERRUN
+				unsigned char _overrunPolicy = UTIMERLIB_OVERRUN_CONTINUE;
+				// Interval period, in _overrunClock units; 0 when it is not checked (timeouts, pulse trains)
+				unsigned long int _overrunPeriod = 0;
+				volatile unsigned long int _missed = 0;
+				// Next call is the pending timer interrupt of a skipped period
+				volatile bool _overrunSkip = false;
+				// Timer was programmed again by timed function, so its start time is not for current period
+				volatile bool _overrunFresh = false;
+				#ifdef ARDUINO_ARCH_AVR
+					bool _overrunPending();
+				#endif
+
+				void _overrunSetup(unsigned long long);
+				bool _overrunEnter();
+				void _overrunExit(unsigned long int);
+			#endif
+
+			#ifdef UTIMERLIB_TRACE
+				// Ring buffer shared by all objects; events are numbered by _traceCount, so dumpTrace() knows overwritten ones
+				static uTimerLibTraceEvent _trace[UTIMERLIB_TRACE_SIZE];
+				static volatile unsigned long int _traceCount;
+				void _traceEvent(unsigned char);
+			#endif
+
+			/**
+			 * \brief Keeps period being programmed for UTIMERLIB_STATS and UTIMERLIB_OVERRUN; nothing without them
+			 */
+			inline void UTIMERLIB_ISR_ATTR _periodSetup(unsigned long long us) {
+				#ifdef UTIMERLIB_STATS
+					_statsSetup(us);
+				#endif
+				#ifdef UTIMERLIB_OVERRUN
+					_overrunSetup(us);
+				#endif
+			}
+
+			void _attachInterrupt_us(unsigned long int);
+			void _attachInterrupt_long(unsigned long long);
+			#ifndef UTIMERLIB_US_ONLY
+				void _attachInterrupt_us64(unsigned long long);
+			#endif
+
+			// Fractional part of period, in timer counts, and its Bresenham accumulator
+			unsigned long int _fracNum = 0;
+			unsigned long int _fracDen = 1;
+			unsigned long int _fracErr = 0;
+
+			#if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+				// Hardware auto-reload: each period is __overflows loops of __remaining + 1 counts, being first _longLoops ones a count longer
+				unsigned long int _longLoops = 0;
+				// Long loops on current period, _longLoops or one more when fraction adds a count
+				unsigned long int _periodLongLoops = 0;
+				void _startPeriod();
+				void _loopsPosition(unsigned long int, bool, unsigned long long &, unsigned long long &);
+			#endif
+
+			bool _readPeriod(unsigned long long &, unsigned long long &, unsigned long int &);
+
+			#ifdef UTIMERLIB_HW_WAVE
+				bool _attachSquareWave(unsigned char, unsigned long int);
+			#endif
+
+			#if defined(UTIMERLIB_HW_AVR)
+				void _attachInterrupt_raw(unsigned char, unsigned long int, unsigned int, unsigned long int);
+			#elif defined(_SAMD21_) || defined(__SAMD51__)
+				void _attachInterrupt_raw(unsigned long int, unsigned long int, unsigned long int, unsigned long int);
+			#elif defined(ARDUINO_ARCH_ESP8266) && defined(UTIMERLIB_ESP8266_TIMER1)
+				void _attachInterrupt_raw(unsigned char, unsigned long long);
+			#elif defined(ARDUINO_ARCH_AVR)
+				void _attachInterrupt_raw(unsigned char, unsigned long int);
+			#elif defined(ARDUINO_ARCH_SAM)
+				void _attachInterrupt_raw(unsigned long int, unsigned long int);
+			#elif defined(_VARIANT_ARDUINO_STM32_)
+				void _attachInterrupt_raw(unsigned long int, unsigned long int, unsigned long int);
+			#endif
+
+			#if !defined(UTIMERLIB_TIMEOUT_ONLY) && !defined(UTIMERLIB_S_ONLY) && UTIMERLIB_SLOTS == 1
+				unsigned long int _attachFrequency(unsigned long int);
+				static unsigned long int _hzToCountsFrac(unsigned long int, unsigned long int, unsigned char, unsigned long int &, unsigned long int &);
+				unsigned char _fitPrescalerHz(unsigned long int, unsigned long int, const unsigned char *, unsigned char, unsigned long int, unsigned long int &);
+				static unsigned long int _milliHz(unsigned long int, unsigned char, unsigned long long, unsigned long int, unsigned long int);
+			#endif
+
+			static unsigned long int _usToCounts(unsigned long int, unsigned long int, unsigned char);
+			static unsigned long int _usToCountsFrac(unsigned long int, unsigned long int, unsigned char, unsigned long int &, unsigned long int &);
+			unsigned long long _longToCounts(unsigned long long, unsigned long int, unsigned char);
+			unsigned char _fracStep();
+			unsigned char _fitPrescaler(unsigned long int, unsigned long int, const unsigned char *, unsigned char, unsigned long int, unsigned long int &);
+			static unsigned char _fitPrescaler(unsigned long int, unsigned long int, const unsigned char *, unsigned char, unsigned long int, unsigned long int &, unsigned long int &, unsigned long int &);
+			static void _splitLoops(unsigned long long, unsigned char, unsigned long int &, unsigned long int &, unsigned long int &);
+
+			#if __cplusplus >= 201103L
+				#if defined(UTIMERLIB_HW_AVR)
+					// AVR, at F_CPU, being k + 1 the CS bits value. Timer2, 8 bit: prescalers 1, 8, 32, 64, 128, 256 and 1024; 16 bit timers: 1, 8, 64, 256 and 1024
+					static constexpr unsigned char _constShift(unsigned char k, unsigned char bits) {
+						return bits == 8 ? (k == 0 ? 0 : k == 1 ? 3 : k == 2 ? 5 : k == 3 ? 6 : k == 4 ? 7 : k == 5 ? 8 : 10) : (k == 0 ? 0 : k == 1 ? 3 : k == 2 ? 6 : k == 3 ? 8 : 10);
+					}
+					static constexpr unsigned char _constLast(unsigned char bits) {
+						return bits == 8 ? 6 : 4;
+					}
+					static constexpr unsigned long long _constHz = F_CPU;
+				#elif defined(_SAMD21_) || defined(__SAMD51__)
+					// TC, 16 bit: prescalers GCLK_TC/16, /64, /256 and /1024; 32 bit: GCLK_TC/1, /2, /4, /8, /16, /64, /256 and /1024
+					static constexpr unsigned char _constShift(unsigned char k, unsigned char bits) {
+						return bits == 32 && k < 4 ? k : bits == 32 ? _constShift(k - 4, 16) : k == 0 ? 4 : k == 1 ? 6 : k == 2 ? 8 : 10;
+					}
+					static constexpr unsigned long int _constPrescalerValue(unsigned char k, unsigned char bits) {
+						return bits == 32 && k < 4 ? (k == 0 ? TC_CTRLA_PRESCALER_DIV1 : k == 1 ? TC_CTRLA_PRESCALER_DIV2 : k == 2 ? TC_CTRLA_PRESCALER_DIV4 : TC_CTRLA_PRESCALER_DIV8) : bits == 32 ? _constPrescalerValue(k - 4, 16) :
+							k == 0 ? TC_CTRLA_PRESCALER_DIV16 : k == 1 ? TC_CTRLA_PRESCALER_DIV64 : k == 2 ? TC_CTRLA_PRESCALER_DIV256 : TC_CTRLA_PRESCALER_DIV1024;
+					}
+					static constexpr unsigned char _constLast(unsigned char bits) {
+						return bits == 32 ? 7 : 3;
+					}
+					#ifdef _SAMD21_
+						static constexpr unsigned long long _constHz = F_CPU; // GCLK0
+					#else
+						static constexpr unsigned long long _constHz = UTIMERLIB_SAMD51_GCLK_HZ;
+					#endif
+				#endif
+
+				#if defined(UTIMERLIB_HW_AVR) || defined(_SAMD21_) || defined(__SAMD51__)
+					// Same rounding than _usToCounts, for a timer of bits width
+					static constexpr unsigned long long _constCounts(unsigned long long us, unsigned char k, unsigned char bits) {
+						return (us * _constHz + (500000ULL << _constShift(k, bits))) / (1000000ULL << _constShift(k, bits));
+					}
+					// Smallest prescaler that fits in one loop, or biggest one
+					static constexpr unsigned char _constPrescaler(unsigned long long us, unsigned char bits, unsigned char k = 0) {
+						return (k == _constLast(bits) || _constCounts(us, k, bits) < (1ULL << bits)) ? k : _constPrescaler(us, bits, k + 1);
+					}
+					// Same truncation and fraction than _usToCountsFrac
+					static constexpr unsigned long long _constFloor(unsigned long long us, unsigned char k, unsigned char bits) {
+						return us * _constHz / (1000000ULL << _constShift(k, bits));
+					}
+					static constexpr unsigned long int _constFracNum(unsigned long long us, unsigned char k, unsigned char bits) {
+						return _constHz % 1000000 == 0 ? (((us & ((1ULL << _constShift(k, bits)) - 1)) * (_constHz / 1000000)) & ((1ULL << _constShift(k, bits)) - 1)) : ((us * _constHz) % (1000000ULL << _constShift(k, bits))) >> _constShift(k, bits);
+					}
+					static constexpr unsigned long int _constFracDen(unsigned char k, unsigned char bits) {
+						return _constHz % 1000000 == 0 ? 1UL << _constShift(k, bits) : 1000000UL;
+					}
+					// Same split than _splitLoops
+					static constexpr unsigned long long _constLoops(unsigned long long counts, unsigned char bits) {
+						return (counts >> bits) + 1;
+					}
+					static constexpr unsigned long long _constShort(unsigned long long counts, unsigned char bits) {
+						return (((_constLoops(counts, bits) << bits) - counts) + _constLoops(counts, bits) - 1) / _constLoops(counts, bits);
+					}
+					static constexpr unsigned long long _constTop(unsigned long long counts, unsigned char bits) {
+						return (1ULL << bits) - _constShort(counts, bits) - 1;
+					}
+					static constexpr unsigned long long _constLongLoops(unsigned long long counts, unsigned char bits) {
+						return _constLoops(counts, bits) * _constShort(counts, bits) - ((_constLoops(counts, bits) << bits) - counts);
+					}
+
+					/**
+					 * \brief Sets timer registers for a constant US time, on a timer of BITS width
+					 */
+					template <unsigned long long US, unsigned char BITS> void _setConstRaw() {
+						static_assert(US < 0xFFFFFFFFFFFFFFFFULL / _constHz / 2, "uTimerLib: time too long");
+						constexpr unsigned char k = _constPrescaler(US, BITS);
+						constexpr unsigned long long counts = _constFloor(US, k, BITS) ? _constFloor(US, k, BITS) : 1;
+						static_assert(_constLoops(counts, BITS) <= 0xFFFFFFFFULL, "uTimerLib: time too long");
+						_fracNum = _constFloor(US, k, BITS) ? _constFracNum(US, k, BITS) : 0;
+						_fracDen = _constFracDen(k, BITS);
+						_fracErr = _fracDen / 2;
+						#if defined(UTIMERLIB_HW_AVR)
+							_attachInterrupt_raw(k + 1, _constLoops(counts, BITS), _constTop(counts, BITS), _constLongLoops(counts, BITS));
+						#else
+							_attachInterrupt_raw(_constPrescalerValue(k, BITS), _constLoops(counts, BITS), _constTop(counts, BITS), _constLongLoops(counts, BITS));
+						#endif
+					}
+				#endif
+
+				/**
+				 * \brief Common part of setInterval<> and setTimeout<>
+				 */
+				template <unsigned long long US> uTimerLibHandle _setConst(uTimerLibDelegate cb, unsigned char type) {
+					static_assert(US > 0, "uTimerLib: time must be greater than 0");
+					#ifdef UTIMERLIB_US_ONLY
+						static_assert(US <= 0xFFFFFFFFULL, "uTimerLib: time too long for UTIMERLIB_US_ONLY");
+					#elif defined(UTIMERLIB_S_ONLY)
+						static_assert(US % 1000000 == 0, "uTimerLib: time must be whole seconds on UTIMERLIB_S_ONLY");
+					#endif
+					#if UTIMERLIB_SLOTS > 1
+						static_assert((US + UTIMERLIB_TICK_US / 2) / UTIMERLIB_TICK_US <= 0x7FFFFFFFULL, "uTimerLib: time too long for scheduler");
+						return _addSlot(cb, type, US < UTIMERLIB_TICK_US / 2 ? 1 : (US + UTIMERLIB_TICK_US / 2) / UTIMERLIB_TICK_US);
+					#else
+						clearTimer();
+						_cb = cb;
+						_type = type;
+						_periodSetup(US);
+						#if defined(UTIMERLIB_HW_AVR) && (UTIMERLIB_TIMERS & (1UL << 2)) && (UTIMERLIB_TIMERS & ~(1UL << 2))
+							// Both Timer2 and 16 bit timers can be used
+							if (_timer == 2) {
+								_setConstRaw<US, 8>();
+							} else {
+								_setConstRaw<US, 16>();
+							}
+						#elif defined(UTIMERLIB_HW_AVR) && (UTIMERLIB_TIMERS & (1UL << 2))
+							_setConstRaw<US, 8>();
+						#elif defined(UTIMERLIB_HW_AVR)
+							_setConstRaw<US, 16>();
+						#elif defined(_SAMD21_) || defined(__SAMD51__)
+							_setConstRaw<US, UTIMERLIB_SAMD_BITS>();
+						#elif defined(UTIMERLIB_US_ONLY)
+							_attachInterrupt_us(US);
+						#else
+							_attachInterrupt_us64(US);
+						#endif
+						return _newHandle(1);
+					#endif
+				}
+			#endif
+
+			#ifdef _VARIANT_ARDUINO_STM32_
+				bool _toInit = true;
+				HardwareTimer *_hwTimer = NULL;
+				unsigned long int _ticks = 0; // Counts of each loop, to add fraction of setFrequency_hz
+				#ifndef BOARD_NAME
+					void (* _handler)() = NULL; // interrupt<N> of selected timer
+				#else
+					unsigned char _waveChannel = 0; // Channel toggling pin on UTIMERLIB_TYPE_WAVE
+				#endif
+			#endif
+
+			#if defined(ARDUINO_ARCH_ESP8266) && !defined(UTIMERLIB_ESP8266_TIMER1)
+				// Virtual timer on OS timer shared by all objects: next running object, next call and period, in us
+				uTimerLib * _osNext = NULL;
+				unsigned long long _osDue = 0;
+				unsigned long long _osPeriod = 0;
+				void _osStart(unsigned long long);
+				void _osStop();
+				static void _osArm();
+				static void _osTick(void *);
+			#endif
+
+			#ifdef ARDUINO_ARCH_ESP32
+				hw_timer_t * _hwTimer = NULL;
+				void (* _handler)() = NULL; // interrupt<N> of selected timer
+				unsigned long long _alarm = 0; // Period, in us
+				void _startAlarm();
+			#endif
+	};
+
+	extern uTimerLib TimerLib;
+
+	#ifdef UTIMERLIB_HW_TIMERS
+		#define UTIMERLIB_CONFIG_TIMERS UTIMERLIB_TIMERS
+	#else
+		#define UTIMERLIB_CONFIG_TIMERS 0
+	#endif
+
+	/**
+	 * \brief Build configuration check: uTimerLib.cpp defines check only for its own configuration
+	 *
+	 * UTIMERLIB_XXX macros change uTimerLib layout, so all files must see same ones. Otherwise link fails with undefined reference to uTimerLibConfig<...>::check
+	 */
+	template <unsigned long SLOTS, unsigned long TICK_US, unsigned long QUEUE_SIZE, unsigned long TRACE_SIZE, unsigned long TIMERS, unsigned long FLAGS> struct uTimerLibConfig {
+		static const char check;
+	};
+
+	typedef uTimerLibConfig<UTIMERLIB_SLOTS, UTIMERLIB_TICK_US, UTIMERLIB_QUEUE_SIZE, UTIMERLIB_TRACE_SIZE, UTIMERLIB_CONFIG_TIMERS, 0UL
+		#ifdef UTIMERLIB_TICKLESS
+			| (1UL << 0)
+		#endif
+		#ifdef UTIMERLIB_DEFERRED
+			| (1UL << 1)
+		#endif
+		#ifdef UTIMERLIB_RTOS
+			| (1UL << 2)
+		#endif
+		#ifdef UTIMERLIB_STATS
+			| (1UL << 3)
+		#endif
+		#ifdef UTIMERLIB_OVERRUN
+			| (1UL << 4)
+		#endif
+		#ifdef UTIMERLIB_TRACE
+			| (1UL << 5)
+		#endif
+		#ifdef UTIMERLIB_GROUP
+			| (1UL << 6)
+		#endif
+		#ifdef UTIMERLIB_PULSE_TRAIN
+			| (1UL << 7)
+		#endif
+		#ifdef UTIMERLIB_SAMPLING
+			| (1UL << 8)
+		#endif
+		#ifdef UTIMERLIB_LOW_POWER
+			| (1UL << 9)
+		#endif
+		#ifdef UTIMERLIB_SAMD_COUNT32
+			| (1UL << 10)
+		#endif
+		#ifdef UTIMERLIB_INTERVAL_ONLY
+			| (1UL << 11)
+		#endif
+		#ifdef UTIMERLIB_TIMEOUT_ONLY
+			| (1UL << 12)
+		#endif
+		#ifdef UTIMERLIB_US_ONLY
+			| (1UL << 13)
+		#endif
+		#ifdef UTIMERLIB_S_ONLY
+			| (1UL << 14)
+		#endif
+		#ifdef UTIMERLIB_ESP8266_TIMER1
+			| (1UL << 15)
+		#endif
+	> uTimerLibThisConfig;
+
+	/**
+	 * \brief Reads check of this file configuration; volatile, so reference is kept on each file including uTimerLib.h
+	 */
+	inline char _uTimerLibConfigCheck() {
+		return *(volatile const char *) &uTimerLibThisConfig::check;
+	}
+
+	static const char _uTimerLibConfigChecked __attribute__((unused)) = _uTimerLibConfigCheck();
+
+	#if __cplusplus >= 201103L
+		/**
+		 * \brief Time literals for setInterval<> and setTimeout<>, all of them in microseconds: 1000_us, 20_ms, 5_s
+		 *
+		 * Not imported globally, as _us, _ms and _s may clash with other libraries: add "using namespace uTimerLibLiterals;"
+		 * where they are used.
+		 */
+		namespace uTimerLibLiterals {
+			constexpr unsigned long long operator"" _us(unsigned long long us) { return us; }
+			constexpr unsigned long long operator"" _ms(unsigned long long ms) { return ms * 1000; }
+			constexpr unsigned long long operator"" _s(unsigned long long s) { return s * 1000000; }
+		}
+	#endif
+
+#endif
+